@@ -3,5 +3,7 @@ make clean && make CXX=g++ CC=gcc EXE=PlentyChess-$args-windows-ssse3.exe arch=s
 make clean && make CXX=g++ CC=gcc EXE=PlentyChess-$args-windows-fma.exe arch=fma -j
 make clean && make profile-build EXE=PlentyChess-$args-windows-avx2.exe arch=avx2 -j profile-build
 make clean && make profile-build EXE=PlentyChess-$args-windows-bmi2.exe arch=bmi2 -j profile-build
+make clean && make profile-build EXE=PlentyChess-$args-windows-avxvnni.exe arch=avxvnni -j profile-build
 make clean && make profile-build EXE=PlentyChess-$args-windows-avx512.exe arch=avx512 -j profile-build
+make clean && make profile-build EXE=PlentyChess-$args-windows-avx512vnni.exe arch=avx512vnni -j profile-build
 make clean && make profile-build EXE=PlentyChess-$args-windows-avx512vbmi2.exe arch=avx512vbmi2 -j profile-build
\ No newline at end of file
@@ -55,6 +55,34 @@ namespace Bench {
         "nqbnrkrb/pppppppp/8/8/8/8/PPPPPPPP/NQBNRKRB w EGeg - 0 1",
     };
 
+    // Mate puzzles that can be solved with checks only, in the EPD format of matetrack
+    const std::vector<std::string> MATE_POSITIONS = {
+        "6rk/6pp/8/6N1/8/8/1Q6/K7 w - - 0 1 bm #1;",
+        "2r4k/6pp/8/4N3/8/1Q6/B5PP/7K w - - 0 1 bm #2;",
+        "r1bqkb1r/pppp1ppp/2n2n2/4p2Q/2B1P3/8/PPPP1PPP/RNB1K1NR w KQkq - 4 4 bm #1;",
+        "6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1 bm #1;",
+        "r1b2k1r/ppp1bppp/8/1B1Q4/5q2/2P5/PPP2PPP/R3R1K1 w - - 1 0 bm #2;",
+        "r2qkb1r/pp2nppp/3p4/2pNN1B1/2BnP3/3P4/PPP2PPP/R2bK2R w KQkq - 1 0 bm #2;",
+        "6k1/pp4p1/2p5/2bp4/8/P5Pb/1P3rrP/2BRRN1K b - - 0 1 bm #2;",
+        "r5rk/5p1p/5R2/4B3/8/8/7P/7K w - - 0 1 bm #3;",
+        "3r1r1k/1p3p1p/p2p4/4n1NN/6bQ/1BPq4/P3p1PP/1R5K w - - 0 1 bm #3;",
+        "rnbqkbnr/ppppp2p/5p2/6p1/4P3/8/PPPP1PPP/RNBQKBNR w KQkq - 0 3 bm #1;",
+        "1k6/pp6/8/8/8/8/5Q2/K2R4 w - - 0 1 bm #3;",
+        "7k/8/5N1K/6Q1/8/8/8/8 w - - 0 1 bm #1;",
+        "r1bk3r/pppq1ppp/5n2/4N1N1/2Bp4/Bn6/P4PPP/4R1K1 w - - 1 0 bm #4;",
+        "4k2r/1R3R2/p3p1pp/4b3/1BnNr3/8/P1P5/5K2 w - - 1 0 bm #4;",
+        "r3k2r/ppp2Npp/1b5n/4p2b/2B1P2q/BQP2P2/P5PP/RN5K w kq - 1 0 bm #3;",
+        "1rb4r/pkPp3p/1b1P3n/1Q6/N3Pp2/8/P1P3PP/7K w - - 1 0 bm #2;",
+        "5Q2/1p3p1N/2p3p1/5b1k/2P3n1/P4RP1/3q2rP/5R1K w - - 1 0 bm #4;",
+        "r1b3k1/pppn3p/3p2rb/3P1K2/2P1P3/2N2P2/PP1QB3/R4R2 b - - 0 1 bm #1;",
+        "2q1nk1r/4Rp2/1ppp1P2/6Pp/3p1B2/3P3P/PPP1Q3/6K1 w - - 0 1 bm #5;",
+        "6k1/1p3pp1/p1b1p2p/q3r1b1/P7/1P5P/1NQ1RPP1/1B4K1 b - - 0 1 bm #4;",
+        "r2q1r2/pp4k1/4pRb1/3pP1p1/3P4/2PQ4/PP1B2P1/6K1 w - - 0 1 bm #4;",
+        "2r3k1/p4p2/3Rp2p/1p2P1pK/8/1P4P1/P3Q2P/1q6 b - - 0 1 bm #3;",
+        "r1bq2r1/b4pk1/p1pp1p2/1p2pP2/1P2P1PB/3P4/1PPQ2P1/R3K2R w KQ - 0 1 bm #2;",
+        "5rk1/1p1q2bp/p2pN1p1/2pP2Bn/2P3P1/1P6/P4QKP/5R2 w - - 1 0 bm #2;",
+    };
+
     const std::vector<std::vector<std::string>> SPEEDTEST_POSITIONS = {
         {
             "rnbq1k1r/ppp1bppp/4pn2/8/2B5/2NP1N2/PPP2PPP/R1BQR1K1 b - - 2 8",
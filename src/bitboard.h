@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+
 #include "types.h"
 
 // Sliding piece stuff
@@ -120,12 +122,6 @@ namespace BB {
     constexpr Bitboard RANK_7 = 0x00FF000000000000;
     constexpr Bitboard RANK_8 = 0xFF00000000000000;
 
-    extern Bitboard BETWEEN[64][64];
-    extern Bitboard LINE[64][64];
-    extern Bitboard KING_ATTACKS[64];
-    extern Bitboard KNIGHT_ATTACKS[64];
-    extern Bitboard RAY_PASS[64][64];
-
     constexpr int popcount(Bitboard bb) {
         return __builtin_popcountll(bb);
     }
@@ -149,10 +145,126 @@ namespace BB {
         return pawnAttacksLeft(pawns, side) | pawnAttacksRight(pawns, side);
     }
 
-    Bitboard kingAttacks(Square origin);
-    Bitboard knightAttacks(Bitboard knightBB);
-    Bitboard attackedSquares(Piece pieceType, Square square, Bitboard occupied, Color stm);
+    constexpr Bitboard kingAttacks(Square origin) {
+        Bitboard attacksBB = bitboard(0);
+
+        for (uint8_t direction = DIRECTIONS[Piece::KING][0]; direction <= DIRECTIONS[Piece::KING][1]; direction++) {
+            Square lastSquare = LASTSQ_TABLE[origin][direction];
+            int safeToSquare = origin + DIRECTION_DELTAS[direction];
+            if (safeToSquare < 0 || safeToSquare >= 64) continue;
+
+            Bitboard toSquareBB = bitboard(static_cast<Square>(safeToSquare));
+            if (origin != lastSquare && toSquareBB)
+                attacksBB |= toSquareBB;
+        }
+        return attacksBB;
+    }
 
-    void init();
+    constexpr Bitboard knightAttacks(Bitboard knightBB) {
+        Bitboard l1 = (knightBB >> 1) & Bitboard(0x7f7f7f7f7f7f7f7f);
+        Bitboard l2 = (knightBB >> 2) & Bitboard(0x3f3f3f3f3f3f3f3f);
+        Bitboard r1 = (knightBB << 1) & Bitboard(0xfefefefefefefefe);
+        Bitboard r2 = (knightBB << 2) & Bitboard(0xfcfcfcfcfcfcfcfc);
+        Bitboard h1 = l1 | r1;
+        Bitboard h2 = l2 | r2;
+        return (h1 << 16) | (h1 >> 16) | (h2 << 8) | (h2 >> 8);
+    }
+
+    // Slider attacks found by walking the rays, for table generation only (search uses the magics)
+    constexpr Bitboard slidingAttacks(Piece pieceType, Square origin, Bitboard blockers) {
+        Bitboard attacksBB = bitboard(0);
+
+        for (uint8_t direction = DIRECTIONS[pieceType][0]; direction <= DIRECTIONS[pieceType][1]; direction++) {
+            int8_t delta = DIRECTION_DELTAS[direction];
+            Square lastSquare = LASTSQ_TABLE[origin][direction];
+
+            if (origin != lastSquare)
+                for (Square toSquare = origin + delta; toSquare < 64; toSquare += delta) {
+                    Bitboard toSquareBB = bitboard(toSquare);
+                    attacksBB |= toSquareBB;
+                    if ((blockers & toSquareBB) || (toSquare == lastSquare))
+                        break;
+                }
+        }
+        return attacksBB;
+    }
+
+    // Attacks of a piece on an otherwise empty board
+    constexpr Bitboard pseudoAttacks(Piece pieceType, Square square, Color stm) {
+        switch (pieceType) {
+        case Piece::PAWN:
+            return pawnAttacks(bitboard(square), stm);
+        case Piece::KNIGHT:
+            return knightAttacks(bitboard(square));
+        case Piece::KING:
+            return kingAttacks(square);
+        default:
+            return slidingAttacks(pieceType, square, bitboard(0));
+        }
+    }
+
+    inline constexpr std::array<Bitboard, 64> KING_ATTACKS = [] {
+        std::array<Bitboard, 64> table{};
+        for (Square square = 0; square < 64; square++)
+            table[square] = kingAttacks(square);
+        return table;
+    }();
+
+    inline constexpr std::array<Bitboard, 64> KNIGHT_ATTACKS = [] {
+        std::array<Bitboard, 64> table{};
+        for (Square square = 0; square < 64; square++)
+            table[square] = knightAttacks(bitboard(square));
+        return table;
+    }();
+
+    using SquarePairTable = std::array<std::array<Bitboard, 64>, 64>;
+
+    inline constexpr SquarePairTable LINE = [] {
+        SquarePairTable table{};
+        for (Square a = 0; a < 64; a++) {
+            Bitboard bishopA = slidingAttacks(Piece::BISHOP, a, bitboard(0));
+            Bitboard rookA = slidingAttacks(Piece::ROOK, a, bitboard(0));
+            for (Square b = 0; b < 64; b++) {
+                if (bishopA & bitboard(b))
+                    table[a][b] |= bishopA & slidingAttacks(Piece::BISHOP, b, bitboard(0));
+                if (rookA & bitboard(b))
+                    table[a][b] |= rookA & slidingAttacks(Piece::ROOK, b, bitboard(0));
+                table[a][b] |= bitboard(a) | bitboard(b);
+            }
+        }
+        return table;
+    }();
+
+    inline constexpr SquarePairTable BETWEEN = [] {
+        SquarePairTable table{};
+        for (Square a = 0; a < 64; a++) {
+            for (Square b = 0; b < 64; b++) {
+                table[a][b] |= slidingAttacks(Piece::BISHOP, a, bitboard(b)) & slidingAttacks(Piece::BISHOP, b, bitboard(a));
+                table[a][b] |= slidingAttacks(Piece::ROOK, a, bitboard(b)) & slidingAttacks(Piece::ROOK, b, bitboard(a));
+                table[a][b] |= bitboard(b);
+                table[a][b] &= LINE[a][b];
+            }
+        }
+        return table;
+    }();
+
+    inline constexpr SquarePairTable RAY_PASS = [] {
+        SquarePairTable table{};
+        for (Square a = 0; a < 64; a++) {
+            for (Square b = 0; b < 64; b++) {
+                for (Piece piece : {Piece::BISHOP, Piece::ROOK}) {
+                    Bitboard pseudoAttacks = slidingAttacks(piece, a, bitboard(0));
+                    if (pseudoAttacks & bitboard(b)) {
+                        table[a][b] = pseudoAttacks;
+                        table[a][b] &= slidingAttacks(piece, b, bitboard(a)) | bitboard(b);
+                        table[a][b] &= ~BETWEEN[a][b];
+                    }
+                }
+            }
+        }
+        return table;
+    }();
+
+    Bitboard attackedSquares(Piece pieceType, Square square, Bitboard occupied, Color stm);
 
 }
\ No newline at end of file
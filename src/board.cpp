@@ -206,11 +206,7 @@ std::string Board::fen() {
 }
 
 template<bool add, bool computeRays>
-__always_inline void Board::updatePieceThreats(Piece piece, Color pieceColor, Square square, NNUE* nnue, Square ignore) {
-#if defined(__AVX512VBMI2__)
-    nnue->updatePieceThreatsGeometry<add, computeRays>(this, piece, pieceColor, square, ignore);
-    return;
-#endif
+__always_inline void Board::updatePieceThreatsBitboards(Piece piece, Color pieceColor, Square square, NNUE* nnue, Square ignore) {
     Bitboard ignoreBB = ignore != NO_SQUARE ? bitboard(ignore) : 0;
 
     // Process attacks of the current piece to other pieces
@@ -278,6 +274,32 @@ __always_inline void Board::updatePieceThreats(Piece piece, Color pieceColor, Sq
     }
 }
 
+template<bool add, bool computeRays>
+__always_inline void Board::updatePieceThreats(Piece piece, Color pieceColor, Square square, NNUE* nnue, Square ignore) {
+    // The AVX2 geometry only breaks even with the bitboards in threatbench, so search keeps the bitboards there
+#if defined(__AVX512VBMI2__)
+    nnue->updatePieceThreatsGeometry<add, computeRays>(this, piece, pieceColor, square, ignore);
+#else
+    updatePieceThreatsBitboards<add, computeRays>(piece, pieceColor, square, nnue, ignore);
+#endif
+}
+
+template<bool geometry>
+void Board::collectPieceThreats(Square square, NNUE* nnue) {
+    Piece piece = pieces[square];
+    Color pieceColor = (byColor[Color::WHITE] & bitboard(square)) ? Color::WHITE : Color::BLACK;
+#if defined(__AVX512VBMI2__) || defined(__AVX2__)
+    if constexpr (geometry) {
+        nnue->updatePieceThreatsGeometry<true, true>(this, piece, pieceColor, square, NO_SQUARE);
+        return;
+    }
+#endif
+    updatePieceThreatsBitboards<true, true>(piece, pieceColor, square, nnue, NO_SQUARE);
+}
+
+template void Board::collectPieceThreats<true>(Square, NNUE*);
+template void Board::collectPieceThreats<false>(Square, NNUE*);
+
 void Board::updatePieceHash(Piece piece, Color pieceColor, Hash hashDelta) {
     if (piece == Piece::PAWN) {
         hashes.pawnHash ^= hashDelta;
@@ -305,6 +327,7 @@ void Board::updatePieceCastling(Piece piece, Color pieceColor, Square origin) {
     }
 }
 
+template<bool updateNNUE>
 void Board::addPiece(Piece piece, Color pieceColor, Square square, NNUE* nnue) {
     assert(pieces[square] == Piece::NONE);
 
@@ -314,11 +337,13 @@ void Board::addPiece(Piece piece, Color pieceColor, Square square, NNUE* nnue) {
 
     pieces[square] = piece;
 
-    updatePieceThreats<true>(piece, pieceColor, square, nnue);
+    if constexpr (updateNNUE)
+        updatePieceThreats<true>(piece, pieceColor, square, nnue);
     updatePieceHash(piece, pieceColor, Zobrist::PIECE_SQUARES[pieceColor][piece][square]);
     updatePieceCastling(piece, pieceColor, square);
 }
 
+template<bool updateNNUE>
 void Board::removePiece(Piece piece, Color pieceColor, Square square, NNUE* nnue) {
     assert(pieces[square] != Piece::NONE);
 
@@ -328,11 +353,13 @@ void Board::removePiece(Piece piece, Color pieceColor, Square square, NNUE* nnue
 
     pieces[square] = Piece::NONE;
 
-    updatePieceThreats<false>(piece, pieceColor, square, nnue);
+    if constexpr (updateNNUE)
+        updatePieceThreats<false>(piece, pieceColor, square, nnue);
     updatePieceHash(piece, pieceColor, Zobrist::PIECE_SQUARES[pieceColor][piece][square]);
     updatePieceCastling(piece, pieceColor, square);
 }
 
+template<bool updateNNUE>
 void Board::movePiece(Piece piece, Color pieceColor, Square origin, Square target, NNUE* nnue) {
     assert(pieces[origin] != Piece::NONE);
     assert(pieces[target] == Piece::NONE);
@@ -344,12 +371,15 @@ void Board::movePiece(Piece piece, Color pieceColor, Square origin, Square targe
     pieces[origin] = Piece::NONE;
     pieces[target] = piece;
 
-    updatePieceThreats<false>(piece, pieceColor, origin, nnue, target);
-    updatePieceThreats<true>(piece, pieceColor, target, nnue);
+    if constexpr (updateNNUE) {
+        updatePieceThreats<false>(piece, pieceColor, origin, nnue, target);
+        updatePieceThreats<true>(piece, pieceColor, target, nnue);
+    }
     updatePieceHash(piece, pieceColor, Zobrist::PIECE_SQUARES[pieceColor][piece][origin] ^ Zobrist::PIECE_SQUARES[pieceColor][piece][target]);
     updatePieceCastling(piece, pieceColor, origin);
 }
 
+template<bool updateNNUE>
 void Board::swapPiece(Piece piece, Color pieceColor, Square square, NNUE* nnue) {
     assert(pieces[square] != Piece::NONE);
 
@@ -362,7 +392,8 @@ void Board::swapPiece(Piece piece, Color pieceColor, Square square, NNUE* nnue)
     byPiece[oldPiece] ^= squareBB;
     pieces[square] = Piece::NONE;
 
-    updatePieceThreats<false, false>(oldPiece, oldPieceColor, square, nnue);
+    if constexpr (updateNNUE)
+        updatePieceThreats<false, false>(oldPiece, oldPieceColor, square, nnue);
     updatePieceHash(oldPiece, oldPieceColor, Zobrist::PIECE_SQUARES[oldPieceColor][oldPiece][square]);
     updatePieceCastling(oldPiece, oldPieceColor, square);
 
@@ -371,11 +402,13 @@ void Board::swapPiece(Piece piece, Color pieceColor, Square square, NNUE* nnue)
     byPiece[piece] ^= squareBB;
     pieces[square] = piece;
 
-    updatePieceThreats<true, false>(piece, pieceColor, square, nnue);
+    if constexpr (updateNNUE)
+        updatePieceThreats<true, false>(piece, pieceColor, square, nnue);
     updatePieceHash(piece, pieceColor, Zobrist::PIECE_SQUARES[pieceColor][piece][square]);
     updatePieceCastling(piece, pieceColor, square);
 }
 
+template<bool updateNNUE>
 void Board::doMove(Move move, Hash newHash, NNUE* nnue) {
     // Increment ply counters
     rule50_ply++;
@@ -384,7 +417,8 @@ void Board::doMove(Move move, Hash newHash, NNUE* nnue) {
         ply++;
     hashes.hash = newHash;
 
-    nnue->incrementAccumulator();
+    if constexpr (updateNNUE)
+        nnue->incrementAccumulator();
 
     // Calculate general information about the move
     Square origin = move.origin();
@@ -410,15 +444,15 @@ void Board::doMove(Move move, Hash newHash, NNUE* nnue) {
     case MoveType::PROMOTION:
 
         if (capturedPiece != Piece::NONE) {
-            removePiece(capturedPiece, flip(stm), captureTarget, nnue);
+            removePiece<updateNNUE>(capturedPiece, flip(stm), captureTarget, nnue);
             dirtyPiece.removePiece = capturedPiece;
             dirtyPiece.removeSquare = captureTarget;
         }
 
-        removePiece(piece, stm, origin, nnue);
+        removePiece<updateNNUE>(piece, stm, origin, nnue);
         rule50_ply = 0;
         promotionPiece = move.promotionPiece();
-        addPiece(promotionPiece, stm, target, nnue);
+        addPiece<updateNNUE>(promotionPiece, stm, target, nnue);
 
         dirtyPiece.target = NO_SQUARE;
         dirtyPiece.addSquare = target;
@@ -433,10 +467,10 @@ void Board::doMove(Move move, Hash newHash, NNUE* nnue) {
         Square rookTarget = Castling::getRookSquare(stm, direction);
         Square kingTarget = Castling::getKingSquare(stm, direction);
 
-        removePiece(Piece::KING, stm, origin, nnue);
-        removePiece(Piece::ROOK, stm, rookOrigin, nnue);
-        addPiece(Piece::KING, stm, kingTarget, nnue);
-        addPiece(Piece::ROOK, stm, rookTarget, nnue);
+        removePiece<updateNNUE>(Piece::KING, stm, origin, nnue);
+        removePiece<updateNNUE>(Piece::ROOK, stm, rookOrigin, nnue);
+        addPiece<updateNNUE>(Piece::KING, stm, kingTarget, nnue);
+        addPiece<updateNNUE>(Piece::ROOK, stm, rookTarget, nnue);
 
         dirtyPiece.target = kingTarget;
         dirtyPiece.removeSquare = rookOrigin;
@@ -447,7 +481,7 @@ void Board::doMove(Move move, Hash newHash, NNUE* nnue) {
                            break;
 
     case MoveType::ENPASSANT:
-        movePiece(piece, stm, origin, target, nnue);
+        movePiece<updateNNUE>(piece, stm, origin, target, nnue);
         rule50_ply = 0;
 
         captureTarget = target - Direction::UP[stm];
@@ -455,7 +489,7 @@ void Board::doMove(Move move, Hash newHash, NNUE* nnue) {
 
         assert(captureTarget < 64);
 
-        removePiece(Piece::PAWN, flip(stm), captureTarget, nnue);
+        removePiece<updateNNUE>(Piece::PAWN, flip(stm), captureTarget, nnue);
 
         dirtyPiece.removePiece = capturedPiece;
         dirtyPiece.removeSquare = captureTarget;
@@ -466,14 +500,14 @@ void Board::doMove(Move move, Hash newHash, NNUE* nnue) {
 
         if (capturedPiece != Piece::NONE) {
             assert(target == captureTarget);
-            removePiece(piece, stm, origin, nnue);
-            swapPiece(piece, stm, target, nnue);
+            removePiece<updateNNUE>(piece, stm, origin, nnue);
+            swapPiece<updateNNUE>(piece, stm, target, nnue);
             rule50_ply = 0;
 
             dirtyPiece.removePiece = capturedPiece;
             dirtyPiece.removeSquare = captureTarget;
         } else {
-            movePiece(piece, stm, origin, target, nnue);
+            movePiece<updateNNUE>(piece, stm, origin, target, nnue);
         }
 
         if (piece == Piece::PAWN) {
@@ -509,16 +543,17 @@ void Board::doMove(Move move, Hash newHash, NNUE* nnue) {
     updateSliderPins(Color::BLACK);
 
     stm = flip(stm);
-    lastMove = move;
 
-    nnue->finalizeMove(this, dirtyPiece);
+    if constexpr (updateNNUE)
+        nnue->finalizeMove(this, dirtyPiece);
 
-    calculateThreats();
+    threatsValid = false;
 }
 
-void Board::doNullMove() {
-    assert(!checkers);
+template void Board::doMove<true>(Move move, Hash newHash, NNUE* nnue);
+template void Board::doMove<false>(Move move, Hash newHash, NNUE* nnue);
 
+void Board::doNullMove() {
     rule50_ply++;
     nullmove_ply = 0;
     hashes.hash ^= Zobrist::STM_BLACK;
@@ -538,9 +573,8 @@ void Board::doNullMove() {
     updateSliderPins(Color::BLACK);
 
     stm = flip(stm);
-    lastMove = Move::none();
 
-    calculateThreats();
+    threatsValid = false;
 }
 
 void Board::calculateThreats() {
@@ -562,25 +596,33 @@ void Board::calculateThreats() {
         threats.rookThreats |= getRookMoves(popLSB(&rooks), occupied);
     }
 
-    threats.queenThreats = 0;
+    // Queen and king threats are only needed for allThreats
+    Bitboard queenThreats = 0;
     Bitboard queens = byPiece[Piece::QUEEN] & byColor[them];
     while (queens) {
         Square square = popLSB(&queens);
-        threats.queenThreats |= getRookMoves(square, occupied);
-        threats.queenThreats |= getBishopMoves(square, occupied);
+        queenThreats |= getRookMoves(square, occupied);
+        queenThreats |= getBishopMoves(square, occupied);
     }
 
-    threats.kingThreats = 0;
+    Bitboard kingThreats = 0;
     Bitboard kings = byPiece[Piece::KING] & byColor[them];
     while (kings) {
-        threats.kingThreats |= BB::KING_ATTACKS[popLSB(&kings)];
+        kingThreats |= BB::KING_ATTACKS[popLSB(&kings)];
     };
 
-    threats.allThreats = threats.pawnThreats | threats.knightThreats | threats.bishopThreats | threats.rookThreats | threats.queenThreats | threats.kingThreats;
+    threats.allThreats = threats.pawnThreats | threats.knightThreats | threats.bishopThreats | threats.rookThreats | queenThreats | kingThreats;
+    threatsValid = true;
+}
+
+bool Board::validateThreats() {
+    Threats cached = threats;
+    calculateThreats();
+    return memcmp(&cached, &threats, sizeof(Threats)) == 0;
 }
 
 bool Board::isSquareThreatened(Square square) {
-    return bitboard(square) & threats.allThreats;
+    return bitboard(square) & getThreats().allThreats;
 }
 
 bool Board::opponentHasGoodCapture() {
@@ -590,6 +632,8 @@ bool Board::opponentHasGoodCapture() {
     Bitboard minors = byColor[stm] & (byPiece[Piece::KNIGHT] | byPiece[Piece::BISHOP]);
     minors |= rooks;
 
+    // Calculates the threats if they are still pending
+    getThreats();
     Bitboard minorThreats = threats.knightThreats | threats.bishopThreats | threats.pawnThreats;
     Bitboard rookThreats = minorThreats | threats.rookThreats;
 
@@ -2,6 +2,8 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <cstddef>
+#include <cassert>
 #include <string>
 #include <sstream>
 
@@ -46,8 +48,6 @@ struct Threats {
     Bitboard knightThreats;
     Bitboard bishopThreats;
     Bitboard rookThreats;
-    Bitboard queenThreats;
-    Bitboard kingThreats;
     Bitboard allThreats;
 };
 
@@ -59,28 +59,31 @@ struct Hashes {
     Hash majorHash;
 };
 
-struct Board {
-    Threats threats;
-    Hashes hashes;
-
+// Copy-make only copies the per-ply state at the front, which doMove updates incrementally from the parent.
+// Move generation and doMove mostly touch the occupancy and the mailbox, which fill the first two cache lines.
+struct alignas(64) Board {
     Bitboard byPiece[Piece::TOTAL];
     Bitboard byColor[2];
-    Bitboard enpassantTarget;
-    Bitboard blockers[2];
-    Bitboard checkers;
-    Move lastMove;
-    uint8_t checkerCount;
     Piece pieces[64];
 
-    Color stm;
+    Hashes hashes;
+    Bitboard enpassantTarget;
 
+    Color stm;
     uint8_t castling;
-    Square castlingSquares[4]; // For each castling right, stores the square of the corresponding rook
-
     uint8_t ply;
     uint8_t rule50_ply;
     uint8_t nullmove_ply;
 
+    // Recomputed by doMove and doNullMove, so it is never copied
+    Bitboard checkers;
+    Threats threats;
+    Bitboard blockers[2];
+    uint8_t checkerCount;
+    bool threatsValid;
+
+    // Set up once per search
+    Square castlingSquares[4]; // For each castling right, stores the square of the corresponding rook
     bool chess960;
 
     void startpos();
@@ -93,18 +96,39 @@ struct Board {
 
     template<bool add, bool computeRays = true>
     __always_inline void updatePieceThreats(Piece piece, Color pieceColor, Square square, NNUE* nnue, Square ignore = NO_SQUARE);
+    template<bool add, bool computeRays>
+    __always_inline void updatePieceThreatsBitboards(Piece piece, Color pieceColor, Square square, NNUE* nnue, Square ignore);
+    // Pushes the threats of the piece on this square like adding it would, using the threat geometry or bitboards
+    template<bool geometry>
+    void collectPieceThreats(Square square, NNUE* nnue);
     void updatePieceHash(Piece piece, Color pieceColor, uint64_t hashDelta);
     void updatePieceCastling(Piece piece, Color pieceColor, Square origin);
 
+    template<bool updateNNUE>
     void addPiece(Piece piece, Color pieceColor, Square square, NNUE* nnue);
+    template<bool updateNNUE>
     void removePiece(Piece piece, Color pieceColor, Square square, NNUE* nnue);
+    template<bool updateNNUE>
     void movePiece(Piece piece, Color pieceColor, Square origin, Square target, NNUE* nnue);
+    template<bool updateNNUE>
     void swapPiece(Piece piece, Color pieceColor, Square square, NNUE* nnue);
 
+    // Without updateNNUE the accumulators and threat features are left alone and nnue may be nullptr
+    template<bool updateNNUE = true>
     void doMove(Move move, Hash newHash, NNUE* nnue);
     void doNullMove();
 
     void calculateThreats();
+    bool validateThreats();
+
+    // Many nodes are cut off before anything reads the threats, so they are only calculated on demand
+    Threats& getThreats() {
+        if (!threatsValid)
+            calculateThreats();
+        assert(validateThreats());
+        return threats;
+    }
+
     bool isSquareThreatened(Square square);
     bool opponentHasGoodCapture();
 
@@ -137,4 +161,7 @@ struct Board {
     int validateBoard();
 };
 
+constexpr size_t BOARD_STATE_SIZE = offsetof(Board, checkers);
+static_assert(BOARD_STATE_SIZE <= 192, "The per-ply board state should fit in three cache lines");
+
 void debugBitboard(Bitboard bb);
@@ -1,30 +1,35 @@
+#include "datagen.h"
 #include "thread.h"
+#include "evaluation.h"
+#include "uci.h"
+#include "fathom/src/tbprobe.h"
 
 #include <fstream>
 #include <iostream>
 #include <filesystem>
+#include <cstring>
+#include <cassert>
 
-std::vector<Move> generateLegalMoves(Board& board) {
-    MoveList moves;
-    generateMoves(&board, moves);
-    std::vector<Move> legalMoves;
-    for (auto& move : moves) {
-        if (board.isLegal(move)) {
-            legalMoves.push_back(move);
-        }
-    }
-    return legalMoves;
-}
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
-bool playRandomMoves(Board& board, Worker* thread, int remainingMoves) {
-    std::vector<Move> legalMoves = generateLegalMoves(board);
+// Plays random moves on the board, then checks with a search that the resulting position is still playable
+bool playRandomMoves(Board& board, Worker* thread, int remainingMoves, std::mt19937_64& random) {
+    MoveList legalMoves;
+    generateLegalMoves(&board, legalMoves);
 
-    if (legalMoves.empty())
+    if (legalMoves.size() == 0)
         return false;
 
     if (remainingMoves == 0) {
 
         // Do a verification search that this position isn't completely busted
+        // Like after parsing a FEN, the history before this position is unknown to the search
+        board.nullmove_ply = 0;
         thread->boardHistory.clear();
         thread->boardHistory.push_back(board.hashes.hash);
         thread->ucinewgame();
@@ -33,21 +38,18 @@ bool playRandomMoves(Board& board, Worker* thread, int remainingMoves) {
         thread->searchParameters.nodes = 1000000;
         thread->rootBoard = board;
         thread->stopped = false;
-        thread->exiting = false;
-        thread->tdatagen();
+        thread->fixedSearch();
+        if (thread->exiting)
+            return false;
 
         Eval verificationScore = thread->rootMoves[0].value;
 
-        if (std::abs(verificationScore) >= 1000)
-            return false;
-        
-        std::cout << "info string genfens " << board.fen() << std::endl;
-        return true;
+        return std::abs(verificationScore) < 1000;
     }
 
     Move move{};
     while (!move) {
-        int r = std::rand() % 100;
+        int r = random() % 100;
         Piece randomPiece = r < 35 ? Piece::PAWN : r < 50 ? Piece::KNIGHT : r < 65 ? Piece::BISHOP : r < 80 ? Piece::QUEEN : r < 95 ? Piece::KING : Piece::ROOK;
         std::vector<Move> pieceMoves;
         for (Move m : legalMoves) {
@@ -55,81 +57,339 @@ bool playRandomMoves(Board& board, Worker* thread, int remainingMoves) {
                 pieceMoves.push_back(m);
         }
         if (!pieceMoves.empty()) {
-            move = pieceMoves[std::rand() % pieceMoves.size()];
+            move = pieceMoves[random() % pieceMoves.size()];
         }
     }
-    Board boardCopy = board;
-    boardCopy.doMove(move, boardCopy.hashAfter(move).first, &thread->nnue);
+    board.doMove<false>(move, board.hashAfter(move).first, nullptr);
 
-    return playRandomMoves(boardCopy, thread, remainingMoves - 1);
+    return playRandomMoves(board, thread, remainingMoves - 1, random);
 }
 
-std::string fenFromBook(std::string bookFile, size_t pos) {
-    std::ifstream file(bookFile);
-    if (file) {
-        file.seekg(pos);
-        std::string line;
-        std::getline(file, line);
-        return line;
+void OpeningBook::buildIndex() {
+    size_t position = 0;
+    const char* newline;
+    while (position < size && (newline = static_cast<const char*>(std::memchr(data + position, '\n', size - position)))) {
+        if (lineOffsets.size() % BLOCK_LINES == 0)
+            blockOffsets.push_back(position);
+        assert(position - blockOffsets.back() <= UINT32_MAX);
+        lineOffsets.push_back(position - blockOffsets.back());
+        position = newline - data + 1;
     }
-    return "";
 }
 
-inline void rtrim(std::string &s) {
-    s.erase(std::find_if(s.rbegin(), s.rend(), [](unsigned char ch) {
-        return !std::isspace(ch);
-    }).base(), s.end());
+bool OpeningBook::loadIndex(const std::string& cachePath, int64_t modifiedTime) {
+    std::ifstream file(cachePath, std::ios::binary);
+    CacheHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != CACHE_MAGIC || header.bookSize != size || header.modifiedTime != modifiedTime)
+        return false;
+
+    blockOffsets.resize(header.blockCount);
+    lineOffsets.resize(header.lineCount);
+    file.read(reinterpret_cast<char*>(blockOffsets.data()), blockOffsets.size() * sizeof(uint64_t));
+    file.read(reinterpret_cast<char*>(lineOffsets.data()), lineOffsets.size() * sizeof(uint32_t));
+    if (!file) {
+        blockOffsets.clear();
+        lineOffsets.clear();
+        return false;
+    }
+    return true;
 }
 
-void Worker::tgenfens() {
-    std::srand(searchParameters.genfensSeed);
-
-    size_t bookSize = 0;
-    std::vector<size_t> lineOffsets;
-    rtrim(searchParameters.genfensBook);
-    std::string bookPath = (std::filesystem::current_path() / searchParameters.genfensBook).string();
-    if (searchParameters.genfensBook.length() > 0 && searchParameters.genfensBook != "None") {
-        std::ifstream f(bookPath);
-        if (!f.good()) {
-            std::cout << "info string unable to find genfens file" << std::endl;
-            return;
-        }
-        {
-            std::ifstream file(bookPath); 
-            bookSize = std::count(std::istreambuf_iterator<char>(file), 
-                std::istreambuf_iterator<char>(), '\n');
+void OpeningBook::saveIndex(const std::string& cachePath, int64_t modifiedTime) {
+    std::ofstream file(cachePath, std::ios::binary);
+    CacheHeader header = { CACHE_MAGIC, size, modifiedTime, lineOffsets.size(), blockOffsets.size() };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(blockOffsets.data()), blockOffsets.size() * sizeof(uint64_t));
+    file.write(reinterpret_cast<const char*>(lineOffsets.data()), lineOffsets.size() * sizeof(uint32_t));
+}
+
+OpeningBook::~OpeningBook() {
+#if !defined(_WIN32)
+    if (data)
+        munmap(const_cast<char*>(data), size);
+#endif
+}
+
+bool OpeningBook::open(const std::string& path) {
+#if defined(_WIN32)
+    std::ifstream file(path, std::ios::binary);
+    if (!file.good())
+        return false;
+    buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    data = buffer.data();
+    size = buffer.size();
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) < 0) {
+        close(fd);
+        return false;
+    }
+    size = fileStat.st_size;
+    if (size > 0) {
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            close(fd);
+            return false;
         }
-        {
-            std::ifstream file(bookPath);
-            std::string line;
-            lineOffsets.push_back(file.tellg());
+        data = static_cast<const char*>(mapping);
+        madvise(mapping, size, MADV_RANDOM);
+    }
+    close(fd);
+#endif
+
+    if (size < CACHE_MIN_SIZE) {
+        buildIndex();
+        return true;
+    }
+
+    std::string cachePath = path + ".idx";
+    std::error_code error;
+    int64_t modifiedTime = std::filesystem::last_write_time(path, error).time_since_epoch().count();
+    if (!loadIndex(cachePath, modifiedTime)) {
+        buildIndex();
+        saveIndex(cachePath, modifiedTime);
+    }
+    return true;
+}
+
+std::string OpeningBook::line(size_t index) const {
+    size_t start = blockOffsets[index / BLOCK_LINES] + lineOffsets[index];
+    const char* end = static_cast<const char*>(std::memchr(data + start, '\n', size - start));
+    return std::string(data + start, end);
+}
+
+std::mt19937_64 datagenRandom(uint64_t seed, uint64_t index) {
+    // splitmix64 of the seed and index, so that neighbouring indices get unrelated streams
+    uint64_t z = (seed << 32 | (index & 0xFFFFFFFF)) + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return std::mt19937_64(z ^ (z >> 31));
+}
+
+void Worker::tgenfens() {
+    OpeningBook* book = threadPool->genfensBook;
+    size_t bookSize = book ? book->lines() : 0;
+
+    // Verification searches run on a private TT and correction history that are cleared for every position,
+    // so their results don't depend on the other workers or on which FENs this worker generated before
+    TranspositionTable verificationTT;
+    SharedHistory verificationHistory(1);
+    SharedHistory* sharedHistory = history.getSharedHistory();
+    int threadIdx = history.getThreadIdx();
+    tt = &verificationTT;
+    history.setSharedHistory(&verificationHistory, 0);
+
+    int fenIndex;
+    while (!exiting && (fenIndex = threadPool->genfensIndex.fetch_add(1, std::memory_order_relaxed)) < searchParameters.genfensFens) {
+
+        // Retries for busted positions continue the same stream, so every FEN only depends on the seed and its index
+        std::mt19937_64 random = datagenRandom(searchParameters.genfensSeed, fenIndex);
+        Board board;
+        bool generated = false;
+        while (!generated && !exiting) {
+            board.startpos();
+            int randomMoves = 8 + random() % 2;
 
-            while (std::getline(file, line)) {
-                lineOffsets.push_back(file.tellg());
+            if (bookSize > 0) {
+                size_t bookPosition = random() % bookSize;
+                std::string fen = book->line(bookPosition);
+                randomMoves = 3 + random() % 2;
+                board.parseFen(fen, false);
             }
+
+            verificationTT.clear(1);
+            generated = playRandomMoves(board, this, randomMoves, random);
+        }
+        if (!generated)
+            break;
+
+        // FENs are printed in index order, whichever worker finishes first
+        std::lock_guard<std::mutex> lock(threadPool->genfensMutex);
+        std::vector<std::string>& results = threadPool->genfensResults;
+        results[fenIndex] = board.fen();
+        while (threadPool->genfensPrinted < results.size() && !results[threadPool->genfensPrinted].empty()) {
+            std::cout << "info string genfens " << results[threadPool->genfensPrinted] << std::endl;
+            std::string().swap(results[threadPool->genfensPrinted++]);
         }
     }
 
-    int generatedFens = 0;
-    while (generatedFens < searchParameters.genfensFens) {
+    tt = &TT;
+    history.setSharedHistory(sharedHistory, threadIdx);
+    history.initHistory();
+    verificationHistory.free();
+}
+
+// One training position in marlinformat layout: 32 bytes, score and result from white's point of view
+struct __attribute__((packed)) PackedRecord {
+    uint64_t occupancy;
+    uint8_t pieces[16]; // 4 bits per occupied square in ascending order: piece type (6 = rook with castling rights) | black << 3
+    uint8_t stmEnpassant; // stm << 7 | enpassant square (64 if none)
+    uint8_t rule50;
+    uint16_t fullmove;
+    int16_t score;
+    uint8_t result; // 0 = black win, 1 = draw, 2 = white win
+    uint8_t unused;
+};
+
+static_assert(sizeof(PackedRecord) == 32, "PackedRecord must be 32 bytes");
+
+PackedRecord packRecord(Board& board, Eval whiteScore) {
+    PackedRecord record = {};
+
+    Bitboard castlingRooks = bitboard(0);
+    for (Color side = Color::WHITE; side <= Color::BLACK; ++side) {
+        if (board.castling & Castling::getMask(side, Castling::KINGSIDE))
+            castlingRooks |= bitboard(board.getCastlingRookSquare(side, Castling::KINGSIDE));
+        if (board.castling & Castling::getMask(side, Castling::QUEENSIDE))
+            castlingRooks |= bitboard(board.getCastlingRookSquare(side, Castling::QUEENSIDE));
+    }
+
+    Bitboard occupied = board.byColor[Color::WHITE] | board.byColor[Color::BLACK];
+    record.occupancy = occupied;
+    for (int i = 0; occupied; i++) {
+        Square square = popLSB(&occupied);
+        uint8_t piece = (castlingRooks & bitboard(square)) ? 6 : board.pieces[square];
+        piece |= (board.byColor[Color::BLACK] & bitboard(square)) ? 8 : 0;
+        record.pieces[i / 2] |= piece << (4 * (i % 2));
+    }
+
+    record.stmEnpassant = (board.stm << 7) | (board.enpassantTarget ? lsb(board.enpassantTarget) : 64);
+    record.rule50 = board.rule50_ply;
+    record.fullmove = board.ply;
+    record.score = whiteScore;
+    return record;
+}
+
+bool insufficientMaterial(Board& board) {
+    Bitboard occupied = board.byColor[Color::WHITE] | board.byColor[Color::BLACK];
+    int pieceCount = BB::popcount(occupied);
+    return pieceCount == 2 || (pieceCount == 3 && (board.byPiece[Piece::KNIGHT] | board.byPiece[Piece::BISHOP]));
+}
+
+bool threefoldRepetition(Board& board, std::vector<Hash>& gameHistory) {
+    int repetitions = 0;
+    int maxPlyOffset = std::min<int>(board.rule50_ply, gameHistory.size() - 1);
+    for (int i = 4; i <= maxPlyOffset; i += 2) {
+        if (gameHistory[gameHistory.size() - 1 - i] == board.hashes.hash && ++repetitions == 2)
+            return true;
+    }
+    return false;
+}
+
+// Adjudication thresholds for self-play games
+constexpr int SELFPLAY_WIN_SCORE = 2500;
+constexpr int SELFPLAY_WIN_PLIES = 6;
+constexpr int SELFPLAY_DRAW_SCORE = 10;
+constexpr int SELFPLAY_DRAW_PLIES = 10;
+constexpr int SELFPLAY_DRAW_MIN_PLY = 80;
 
-        // Set up a fresh board
+void Worker::tselfplay() {
+    std::string outputPath = threadPool->selfplayOutput + "_" + std::to_string(threadId) + ".bin";
+    std::ofstream output(outputPath, std::ios::binary | std::ios::app);
+    if (!output.good()) {
+        std::cout << "info string unable to open " << outputPath << std::endl;
+        return;
+    }
+
+    SearchParameters gameParameters = searchParameters;
+    std::vector<PackedRecord> records;
+    std::vector<Hash> gameHistory;
+
+    int gameIndex;
+    while ((gameIndex = threadPool->selfplayGameIndex.fetch_add(1, std::memory_order_relaxed)) < gameParameters.selfplayGames) {
+
+        // Openings are made the same way as for genfens
+        std::mt19937_64 random = datagenRandom(gameParameters.selfplaySeed, gameIndex);
         Board board;
-        board.startpos();
-        nnue.reset(&board);
+        do {
+            board.startpos();
+            searchParameters = gameParameters;
+            if (exiting)
+                return;
+        } while (!playRandomMoves(board, this, 8 + random() % 2, random));
 
-        int randomMoves = 8 + std::rand() % 2;
+        ucinewgame();
+        gameHistory.assign(1, board.hashes.hash);
+        records.clear();
 
-        if (bookSize > 0) {
-            size_t bookPosition = std::rand() % bookSize;
-            std::string fen = fenFromBook(bookPath, lineOffsets[bookPosition]);
-            randomMoves = 3 + std::rand() % 2;
-            board.parseFen(fen, false);
-        }
+        int winPlies = 0, drawPlies = 0, gamePlies = 0;
+        uint8_t result;
+        while (true) {
+            MoveList moves;
+            generateLegalMoves(&board, moves);
+            if (moves.size() == 0) {
+                result = !board.checkers ? 1 : board.stm == Color::WHITE ? 0 : 2;
+                break;
+            }
+            if (board.rule50_ply >= 100 || insufficientMaterial(board) || threefoldRepetition(board, gameHistory)) {
+                result = 1;
+                break;
+            }
+
+            if (!board.castling && BB::popcount(board.byColor[Color::WHITE] | board.byColor[Color::BLACK]) <= std::min(int(TB_LARGEST), UCI::Options.syzygyProbeLimit.value)) {
+                unsigned wdl = tb_probe_wdl(
+                    board.byColor[Color::WHITE],
+                    board.byColor[Color::BLACK],
+                    board.byPiece[Piece::KING],
+                    board.byPiece[Piece::QUEEN],
+                    board.byPiece[Piece::ROOK],
+                    board.byPiece[Piece::BISHOP],
+                    board.byPiece[Piece::KNIGHT],
+                    board.byPiece[Piece::PAWN],
+                    0,
+                    0,
+                    board.enpassantTarget ? lsb(board.enpassantTarget) : 0,
+                    board.stm == Color::WHITE
+                );
+                if (wdl != TB_RESULT_FAILED) {
+                    bool stmWins = wdl == TB_WIN, stmLoses = wdl == TB_LOSS;
+                    result = stmWins ? (board.stm == Color::WHITE ? 2 : 0) : stmLoses ? (board.stm == Color::WHITE ? 0 : 2) : 1;
+                    break;
+                }
+            }
 
-        // Play random moves
-        if (playRandomMoves(board, this, randomMoves)) {
-            generatedFens++;
+            rootBoard = board;
+            boardHistory = gameHistory;
+            rootMoves.clear();
+            searchParameters = gameParameters;
+            stopped = false;
+            fixedSearch();
+            if (exiting)
+                return;
+
+            Move bestMove = rootMoves[0].move;
+            Eval whiteScore = board.stm == Color::WHITE ? rootMoves[0].value : -rootMoves[0].value;
+
+            // Adjudicate decided and dead drawn games
+            winPlies = std::abs(whiteScore) >= SELFPLAY_WIN_SCORE ? winPlies + 1 : 0;
+            drawPlies = std::abs(whiteScore) <= SELFPLAY_DRAW_SCORE ? drawPlies + 1 : 0;
+            if (winPlies >= SELFPLAY_WIN_PLIES) {
+                result = whiteScore > 0 ? 2 : 0;
+                break;
+            }
+            if (gamePlies >= SELFPLAY_DRAW_MIN_PLY && drawPlies >= SELFPLAY_DRAW_PLIES) {
+                result = 1;
+                break;
+            }
+
+            // Only quiet positions are kept for training
+            if (!board.checkers && !board.isCapture(bestMove) && !bestMove.isPromotion() && std::abs(whiteScore) < EVAL_TBWIN_IN_MAX_PLY)
+                records.push_back(packRecord(board, whiteScore));
+
+            Hash newHash = board.hashAfter(bestMove).first;
+            board.doMove<false>(bestMove, newHash, nullptr);
+            gameHistory.push_back(newHash);
+            gamePlies++;
         }
+
+        for (PackedRecord& record : records)
+            record.result = result;
+        output.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(PackedRecord));
+
+        threadPool->selfplayGamesPlayed.fetch_add(1, std::memory_order_relaxed);
+        threadPool->selfplayPositions.fetch_add(records.size(), std::memory_order_relaxed);
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <random>
+
+// Memory-mapped opening book, FENs are read straight from the mapping through an index of line starts
+class OpeningBook {
+
+    // Line starts are stored relative to the start of their block to keep the index at 4 bytes per line
+    static constexpr size_t BLOCK_LINES = 256;
+    // Indices of smaller books are quick enough to build that they are not cached on disk
+    static constexpr size_t CACHE_MIN_SIZE = 64 * 1024 * 1024;
+    static constexpr uint64_t CACHE_MAGIC = 0x31584449424B4F42; // "BOOKIDX1"
+
+    struct CacheHeader {
+        uint64_t magic;
+        uint64_t bookSize;
+        int64_t modifiedTime;
+        uint64_t lineCount;
+        uint64_t blockCount;
+    };
+
+    const char* data = nullptr;
+    size_t size = 0;
+#if defined(_WIN32)
+    std::vector<char> buffer;
+#endif
+
+    std::vector<uint64_t> blockOffsets;
+    std::vector<uint32_t> lineOffsets;
+
+    void buildIndex();
+    bool loadIndex(const std::string& cachePath, int64_t modifiedTime);
+    void saveIndex(const std::string& cachePath, int64_t modifiedTime);
+
+public:
+
+    OpeningBook() = default;
+    OpeningBook(const OpeningBook&) = delete;
+    OpeningBook& operator=(const OpeningBook&) = delete;
+    ~OpeningBook();
+
+    bool open(const std::string& path);
+
+    // Only lines terminated by a newline are counted
+    size_t lines() const {
+        return lineOffsets.size();
+    }
+
+    std::string line(size_t index) const;
+};
+
+// Random stream for the generated FEN or game with the given index, independent of which worker plays it
+std::mt19937_64 datagenRandom(uint64_t seed, uint64_t index);
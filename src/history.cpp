@@ -134,6 +134,7 @@ void History::initHistory() {
     memset(continuationHistory, 0, sizeof(continuationHistory));
     memset(captureHistory, 0, sizeof(captureHistory));
     memset(continuationCorrectionHistory, 0, sizeof(continuationCorrectionHistory));
+    quietOrderingStats.clear();
 
     for (int i = 0; i < PAWN_HISTORY_SIZE; i++) {
         for (int j = 0; j < 2; j++) {
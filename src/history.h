@@ -12,6 +12,16 @@ struct SearchedMove {
 
 using SearchedMoveList = ArrayVec<SearchedMove, 32>;
 
+struct QuietOrderingStats {
+    uint64_t scored;
+    uint64_t returned;
+
+    void clear() {
+        scored = 0;
+        returned = 0;
+    }
+};
+
 constexpr int PAWN_HISTORY_SIZE = 8192;
 constexpr int CORRECTION_HISTORY_SIZE = 16384;
 constexpr int CORRECTION_HISTORY_LIMIT = 1024;
@@ -68,11 +78,27 @@ public:
     int16_t continuationHistory[2][2][2][Piece::TOTAL][64][Piece::TOTAL * 64 * 2];
     int16_t continuationCorrectionHistory[2][Piece::TOTAL][64][2][2];
 
+    QuietOrderingStats quietOrderingStats;
+
     History() = delete;
     History(int _threadIdx, SharedHistory* _sharedHistory): threadIdx(_threadIdx), sharedHistory(_sharedHistory) {}
 
     void initHistory();
 
+    SharedHistory* getSharedHistory() {
+        return sharedHistory;
+    }
+
+    int getThreadIdx() {
+        return threadIdx;
+    }
+
+    // genfens swaps in a private correction history, so its verification searches don't depend on the other workers
+    void setSharedHistory(SharedHistory* _sharedHistory, int _threadIdx) {
+        sharedHistory = _sharedHistory;
+        threadIdx = _threadIdx;
+    }
+
     int getCorrectionValue(Board* board, SearchStack* searchStack);
     Eval correctStaticEval(uint8_t rule50, Eval eval, int correctionValue);
     void updateCorrectionHistory(Board* board, SearchStack* searchStack, int16_t bonus);
@@ -1,54 +1,16 @@
-#include <vector>
-#include <random>
-#include <inttypes.h>
-#include <chrono>
-#include <iostream>
+#include <cassert>
 
 #include "types.h"
 #include "magic.h"
 #include "move.h"
 #include "bitboard.h"
 
-#if defined(USE_BMI2)
-
 MagicEntry ROOK_MAGICS[64] = {};
 MagicEntry BISHOP_MAGICS[64] = {};
 
 Bitboard ROOK_MOVES[102400] = { bitboard(0) };
 Bitboard BISHOP_MOVES[5248] = { bitboard(0) };
 
-#else
-
-MagicEntry ROOK_MAGICS[64] = {};
-MagicEntry BISHOP_MAGICS[64] = {};
-
-Bitboard ROOK_MOVES[64][4096] = { {bitboard(0)} };
-Bitboard BISHOP_MOVES[64][4096] = { {bitboard(0)} };
-
-#endif
-
-Bitboard sliderMoves(Piece pieceType, Square origin, Bitboard blockers) {
-    Bitboard attacksBB = bitboard(0);
-
-    int8_t delta, direction;
-    Square lastSquare, toSquare;
-    Bitboard toSquareBB;
-
-    for (direction = DIRECTIONS[pieceType][0]; direction <= DIRECTIONS[pieceType][1]; direction++) {
-        delta = DIRECTION_DELTAS[direction];
-        lastSquare = LASTSQ_TABLE[origin][direction];
-
-        if (origin != lastSquare)
-            for (toSquare = origin + delta; toSquare < 64; toSquare += delta) {
-                toSquareBB = bitboard(toSquare);
-                attacksBB |= toSquareBB;
-                if ((blockers & toSquareBB) || (toSquare == lastSquare))
-                    break;
-            }
-    }
-    return attacksBB;
-}
-
 Bitboard relevantBlockers(Piece pieceType, Square origin) {
     Bitboard attacksBB = bitboard(0);
 
@@ -69,95 +31,78 @@ Bitboard relevantBlockers(Piece pieceType, Square origin) {
     return attacksBB;
 }
 
-#if defined(USE_BMI2)
+#if !defined(USE_BMI2)
+
+// Fancy magic numbers mapping each square onto exactly 2^popcount(mask) entries, found once with a seeded random search
+constexpr uint64_t ROOK_MAGIC_NUMBERS[64] = {
+    0x0280132180004001ULL, 0x0140001000200040ULL, 0x0880200010000880ULL, 0x2080080005801000ULL,
+    0x0200041020080200ULL, 0x0200041041084200ULL, 0x0400080081124410ULL, 0x2180042100004080ULL,
+    0x8000800099644000ULL, 0x0802003040820100ULL, 0x0105801001862000ULL, 0x0101002008100100ULL,
+    0x1000800400080080ULL, 0x0804800200040080ULL, 0x2001800200800900ULL, 0x00160004088204C1ULL,
+    0x228000C001402000ULL, 0x8510004000200050ULL, 0x3001848020029000ULL, 0x0280808010000801ULL,
+    0x0109010010040800ULL, 0x8000808004000200ULL, 0x8000040081021028ULL, 0x40040A0009004884ULL,
+    0x80C0004280008035ULL, 0x0010004040002000ULL, 0x1101200500410070ULL, 0x8410100080080080ULL,
+    0x000C080080800400ULL, 0x4012008080040002ULL, 0x4000040101000200ULL, 0x0061010200008044ULL,
+    0x0080804010800020ULL, 0x3000201008400040ULL, 0x4112008012002444ULL, 0x0848000880801000ULL,
+    0x00A8008008800400ULL, 0x200200280A00500CULL, 0x080A221024004801ULL, 0xC400008042000104ULL,
+    0x8000400080028022ULL, 0x0220008040018020ULL, 0x4000200011010040ULL, 0x10060040210A0010ULL,
+    0x40820020904A0004ULL, 0x0030040002008080ULL, 0x0200020801840010ULL, 0x0084C04100820004ULL,
+    0x4802010080C2A600ULL, 0x0000400080201880ULL, 0x2040801000200080ULL, 0x0180200842001200ULL,
+    0x0013510008000500ULL, 0x0182000C00808A80ULL, 0x1000524821302400ULL, 0x3800040108488200ULL,
+    0x104A004810210082ULL, 0x0004210010420082ULL, 0xC424110008200241ULL, 0x90101000A0088501ULL,
+    0x0182000420100802ULL, 0x4822001001080402ULL, 0x05D0080090012204ULL, 0x2008140089042846ULL,
+};
+
+constexpr uint64_t BISHOP_MAGIC_NUMBERS[64] = {
+    0x0420220228022C80ULL, 0x200208010C108000ULL, 0x1004010411040040ULL, 0x12A4040292002440ULL,
+    0x0804042082000850ULL, 0x0802020220010440ULL, 0x800401048260201AULL, 0x0041010800828800ULL,
+    0x4040641488080104ULL, 0x20002004016E0020ULL, 0x0C2C223A12420042ULL, 0x0100024081020220ULL,
+    0x0383211041025080ULL, 0x08C0030420160600ULL, 0x0C1000510808C00AULL, 0x40501A0084140280ULL,
+    0x40280040112C0088ULL, 0x4020040908110050ULL, 0x1028001008801412ULL, 0x0104220202020000ULL,
+    0x800A000400940010ULL, 0x0401000200512410ULL, 0x1082012100900408ULL, 0x0101402208440C00ULL,
+    0x00482104C01C1111ULL, 0x0310105008017101ULL, 0x0022010108080020ULL, 0x02300400104010A0ULL,
+    0x1401010011444000ULL, 0x1001020000405020ULL, 0x00010A0804480411ULL, 0x0419220010404400ULL,
+    0x0010020A00200820ULL, 0xA008280909040104ULL, 0x0210209010080020ULL, 0x3006110800040040ULL,
+    0x0800820200440090ULL, 0x0008100421810080ULL, 0x0028060093264800ULL, 0x0A08004088810080ULL,
+    0x3611100290442000ULL, 0x0241081282001001ULL, 0x11081108010D0800ULL, 0x002A102014420800ULL,
+    0x480002600A004500ULL, 0x8001010102000100ULL, 0x2008080810410883ULL, 0x0002080901101022ULL,
+    0x2800942420444080ULL, 0x2000840108024000ULL, 0x0000804844100040ULL, 0x1444120020884540ULL,
+    0x0004001002020C00ULL, 0x041041C801010049ULL, 0x0060045000850810ULL, 0x1003240C14820208ULL,
+    0x3010104A10100800ULL, 0x0280020101580200ULL, 0x1000000101081600ULL, 0x0644009800420200ULL,
+    0x0050040008102402ULL, 0x00000004601C8106ULL, 0x00088530040812A0ULL, 0x800218010102020CULL,
+};
+
+#endif
 
-// Finds magics for a given piece/square combination
-void findMagics(Piece slider, MagicEntry* magicTable, Bitboard* table) {
+// Fills in the packed attack table of a slider, every square taking the next 2^popcount(mask) entries
+void makeTables(Piece slider, MagicEntry* magicTable, Bitboard* table) {
     for (Square square = 0; square < 64; square++) {
         MagicEntry* outMagicEntry = &magicTable[square];
 
         Bitboard blockers = bitboard(0);
         Bitboard mask = relevantBlockers(slider, square);
 
-        outMagicEntry->tableIndex = table;
         outMagicEntry->mask = mask;
+        outMagicEntry->tableIndex = table;
+#if !defined(USE_BMI2)
+        outMagicEntry->magic = slider == Piece::ROOK ? ROOK_MAGIC_NUMBERS[square] : BISHOP_MAGIC_NUMBERS[square];
+        outMagicEntry->shift = 64 - BB::popcount(mask);
+#endif
 
+        // Iterate all configurations of blockers
         for (int index = 0; blockers != bitboard(0) || index == 0; index++) {
-            Bitboard moves = sliderMoves(slider, square, blockers);
-            if (slider == Piece::ROOK)
-                outMagicEntry->tableIndex[magicIndexRook(square, blockers)] = moves;
-            else
-                outMagicEntry->tableIndex[magicIndexBishop(square, blockers)] = moves;
-            blockers = (blockers - mask) & mask;
-            table++;
-        }
-    }
-}
-
-#else
-
-// Attempt to fill in a hash table using a magic number.
-// Fails if there are any non-constructive collisions.
-bool tryMakeTable(Piece slider, Square square, MagicEntry magicEntry, Bitboard* table) {
-    for (int i = 0; i < 4096; i++)
-        table[i] = bitboard(0);
-
-    Bitboard blockers = bitboard(0);
-
-    // Iterate all configurations of blockers
-    for (int index = 0; blockers != bitboard(0) || index == 0; index++) {
-        Bitboard moves = sliderMoves(slider, square, blockers);
-        Bitboard* tableEntry = &table[magicIndex(magicEntry, blockers)];
-        if (*tableEntry == 0) {
+            Bitboard moves = BB::slidingAttacks(slider, square, blockers);
+            Bitboard* tableEntry = &outMagicEntry->tableIndex[magicIndex(*outMagicEntry, blockers)];
+            assert(*tableEntry == 0 || *tableEntry == moves);
             *tableEntry = moves;
-        }
-        else if (*tableEntry != moves) {
-            return false;
-        }
 
-        blockers = (blockers - magicEntry.mask) & magicEntry.mask;
-    }
-    return true;
-}
-
-// Finds magics for a given piece/square combination
-void findMagic(uint32_t seed, Piece slider, Square square, uint8_t indexBits, MagicEntry* outMagicEntry, Bitboard* table) {
-    std::mt19937 rng;
-    rng.seed(seed);
-    std::uniform_int_distribution<uint64_t> dist;
-
-    Bitboard mask = relevantBlockers(slider, square);
-    for (int i = 0; i < 100000000; i++) {
-        Bitboard magic = dist(rng) & dist(rng) & dist(rng);
-        MagicEntry magicEntry;
-        magicEntry.mask = mask;
-        magicEntry.magic = magic;
-        magicEntry.shift = 64 - indexBits;
-        if (tryMakeTable(slider, square, magicEntry, table)) {
-            *outMagicEntry = magicEntry;
-            return;
+            blockers = (blockers - mask) & mask;
+            table++;
         }
     }
-    std::cout << "NO MAGICS FOUND FOR SLIDER " << slider << " / SQUARE " << square << std::endl;
-    exit(-1);
 }
 
-#endif
-
 void generateMagics() {
-    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
-
-#if defined(USE_BMI2)
-    findMagics(Piece::ROOK, ROOK_MAGICS, ROOK_MOVES);
-    findMagics(Piece::BISHOP, BISHOP_MAGICS, BISHOP_MOVES);
-#else
-    uint32_t seed = 2816384844;
-
-    for (Square square = 0; square < 64; square++) {
-        findMagic(seed, Piece::ROOK, square, 12, &ROOK_MAGICS[square], ROOK_MOVES[square]);
-        findMagic(seed, Piece::BISHOP, square, 9, &BISHOP_MAGICS[square], BISHOP_MOVES[square]);
-    }
-#endif
-    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
-    std::cout << "Generated magics in " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << "ms" << std::endl;
-}
\ No newline at end of file
+    makeTables(Piece::ROOK, ROOK_MAGICS, ROOK_MOVES);
+    makeTables(Piece::BISHOP, BISHOP_MAGICS, BISHOP_MOVES);
+}
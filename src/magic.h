@@ -5,11 +5,16 @@
 #include "types.h"
 
 #if defined(USE_BMI2)
-
 #include <immintrin.h>
+#endif
 
+// Both paths share the same packed tables, each square owning 2^popcount(mask) entries
 struct MagicEntry {
     Bitboard mask;
+#if !defined(USE_BMI2)
+    uint64_t magic;
+    uint8_t shift;
+#endif
     Bitboard* tableIndex;
 
     MagicEntry() {}
@@ -21,43 +26,7 @@ extern MagicEntry BISHOP_MAGICS[64];
 extern Bitboard ROOK_MOVES[102400];
 extern Bitboard BISHOP_MOVES[5248];
 
-#else
-
-struct MagicEntry {
-    Bitboard mask;
-    uint64_t magic;
-    uint8_t shift;
-
-    MagicEntry() {}
-};
-
-extern MagicEntry ROOK_MAGICS[64];
-extern MagicEntry BISHOP_MAGICS[64];
-
-extern Bitboard ROOK_MOVES[64][4096];
-extern Bitboard BISHOP_MOVES[64][4096];
-
-inline size_t magicIndex(MagicEntry entry, Bitboard occupied) {
-    Bitboard blockers = occupied & entry.mask;
-    blockers *= entry.magic;
-    return blockers >> entry.shift;
-}
-
-#endif
-
-inline size_t magicIndexRook(Square square, Bitboard occupied) {
-    MagicEntry entry = ROOK_MAGICS[square];
-#if defined(USE_BMI2)
-    return (size_t)_pext_u64(occupied, entry.mask);
-#else
-    Bitboard blockers = occupied & entry.mask;
-    blockers *= entry.magic;
-    return blockers >> entry.shift;
-#endif
-}
-
-inline size_t magicIndexBishop(Square square, Bitboard occupied) {
-    MagicEntry entry = BISHOP_MAGICS[square];
+inline size_t magicIndex(const MagicEntry& entry, Bitboard occupied) {
 #if defined(USE_BMI2)
     return (size_t)_pext_u64(occupied, entry.mask);
 #else
@@ -68,19 +37,13 @@ inline size_t magicIndexBishop(Square square, Bitboard occupied) {
 }
 
 inline Bitboard getRookMoves(Square square, Bitboard occupied) {
-#if defined(USE_BMI2)
-    return ROOK_MAGICS[square].tableIndex[magicIndexRook(square, occupied)];
-#else
-    return ROOK_MOVES[square][magicIndexRook(square, occupied)];
-#endif
+    const MagicEntry& entry = ROOK_MAGICS[square];
+    return entry.tableIndex[magicIndex(entry, occupied)];
 }
 
 inline Bitboard getBishopMoves(Square square, Bitboard occupied) {
-#if defined(USE_BMI2)
-    return BISHOP_MAGICS[square].tableIndex[magicIndexBishop(square, occupied)];
-#else
-    return BISHOP_MOVES[square][magicIndexBishop(square, occupied)];
-#endif
+    const MagicEntry& entry = BISHOP_MAGICS[square];
+    return entry.tableIndex[magicIndex(entry, occupied)];
 }
 
 void generateMagics();
\ No newline at end of file
@@ -21,9 +21,54 @@ TUNE_INT(mpThreatQueenValue, 19431, 10000, 30000);
 TUNE_INT(mpThreatRookValue, 12315, 7500, 17500);
 TUNE_INT(mpThreatKnightValue, 7973, 5000, 10000);
 
-void generatePawn_quiet(Board* board, MoveList& moves, Bitboard targetMask) {
+constexpr int QUIET_SELECTIONS = 4;
+
+// Restrictions on the generated moves. Pseudo-legal generation only uses the check mask, legal generation
+// also keeps pinned pieces on their pin line and the king off attacked squares
+struct MoveMasks {
+    Square king;
+    Bitboard checkMask;
+    Bitboard pinned;
+    Bitboard kingTargets;
+    bool legal;
+};
+
+MoveMasks pseudoLegalMasks(Board* board) {
+    MoveMasks masks;
+    masks.king = lsb(board->byPiece[Piece::KING] & board->byColor[board->stm]);
+    // If in check, only generate targets that take care of the check
+    masks.checkMask = board->checkers ? BB::BETWEEN[masks.king][lsb(board->checkers)] : ~bitboard(0);
+    masks.pinned = bitboard(0);
+    masks.kingTargets = ~bitboard(0);
+    masks.legal = false;
+    return masks;
+}
+
+MoveMasks legalMasks(Board* board) {
+    MoveMasks masks = pseudoLegalMasks(board);
+    masks.pinned = board->blockers[board->stm] & board->byColor[board->stm];
+    masks.legal = true;
+
+    // Squares behind the king stay attacked by a checking slider once the king steps off them
+    Bitboard kingDanger = board->getThreats().allThreats;
+    Bitboard sliderCheckers = board->checkers & ~board->byPiece[Piece::PAWN] & ~board->byPiece[Piece::KNIGHT];
+    while (sliderCheckers) {
+        Square checker = popLSB(&sliderCheckers);
+        kingDanger |= BB::LINE[checker][masks.king] & ~bitboard(checker);
+    }
+    masks.kingTargets = ~kingDanger;
+    return masks;
+}
+
+// Pinned pieces may only move along the line through their king
+inline bool keepsPin(const MoveMasks& masks, Square origin, Square target) {
+    return !(masks.pinned & bitboard(origin)) || (BB::LINE[masks.king][origin] & bitboard(target));
+}
+
+void generatePawn_quiet(Board* board, MoveList& moves, const MoveMasks& masks) {
     Bitboard pawns = board->byPiece[Piece::PAWN] & board->byColor[board->stm];
     Bitboard free = ~(board->byColor[Color::WHITE] | board->byColor[Color::BLACK]);
+    Bitboard targetMask = masks.checkMask;
 
     Bitboard pushedPawns, secondRankPawns, doublePushedPawns, enemyBackrank;
     if (board->stm == Color::WHITE) {
@@ -42,6 +87,8 @@ void generatePawn_quiet(Board* board, MoveList& moves, Bitboard targetMask) {
     while (pushedPawns) {
         Square target = popLSB(&pushedPawns);
         Square origin = target - Direction::UP[board->stm];
+        if (!keepsPin(masks, origin, target))
+            continue;
 
         if (bitboard(target) & enemyBackrank) {
             // Promotion: Queen promotions are considered captures
@@ -57,11 +104,13 @@ void generatePawn_quiet(Board* board, MoveList& moves, Bitboard targetMask) {
     // Double pushes
     while (doublePushedPawns) {
         Square target = popLSB(&doublePushedPawns);
-        moves.add(Move::makeNormal(target - Direction::UP_DOUBLE[board->stm], target));
+        Square origin = target - Direction::UP_DOUBLE[board->stm];
+        if (keepsPin(masks, origin, target))
+            moves.add(Move::makeNormal(origin, target));
     }
 }
 
-void generatePawn_capture(Board* board, MoveList& moves, Bitboard targetMask) {
+void generatePawn_capture(Board* board, MoveList& moves, const MoveMasks& masks) {
     // Captures
     Bitboard pawns = board->byPiece[Piece::PAWN] & board->byColor[board->stm];
     Bitboard pAttacksLeft = BB::pawnAttacksLeft(pawns, board->stm);
@@ -69,6 +118,7 @@ void generatePawn_capture(Board* board, MoveList& moves, Bitboard targetMask) {
     Bitboard blockedEnemy = board->byColor[1 - board->stm];
     Bitboard enemyBackrank = board->stm == Color::WHITE ? BB::RANK_8 : BB::RANK_1;
     Bitboard free = ~(board->byColor[Color::WHITE] | board->byColor[Color::BLACK]);
+    Bitboard targetMask = masks.checkMask;
 
     // Queen promotions (without capture)
     Bitboard pushedPawns;
@@ -80,7 +130,9 @@ void generatePawn_capture(Board* board, MoveList& moves, Bitboard targetMask) {
     }
     while (pushedPawns) {
         Square target = popLSB(&pushedPawns);
-        moves.add(Move::makePromotion(target - Direction::UP[board->stm], target, Piece::QUEEN));
+        Square origin = target - Direction::UP[board->stm];
+        if (keepsPin(masks, origin, target))
+            moves.add(Move::makePromotion(origin, target, Piece::QUEEN));
     }
 
     // Capture promotions
@@ -88,6 +140,8 @@ void generatePawn_capture(Board* board, MoveList& moves, Bitboard targetMask) {
     while (leftCaptures) {
         Square target = popLSB(&leftCaptures);
         Square origin = target - Direction::UP_LEFT[board->stm];
+        if (!keepsPin(masks, origin, target))
+            continue;
 
         if (bitboard(target) & enemyBackrank) {
             // Promotion
@@ -103,6 +157,8 @@ void generatePawn_capture(Board* board, MoveList& moves, Bitboard targetMask) {
     while (rightCaptures) {
         Square target = popLSB(&rightCaptures);
         Square origin = target - Direction::UP_RIGHT[board->stm];
+        if (!keepsPin(masks, origin, target))
+            continue;
 
         if (bitboard(target) & enemyBackrank) {
             // Promotion
@@ -123,27 +179,31 @@ void generatePawn_capture(Board* board, MoveList& moves, Bitboard targetMask) {
         if (~targetMask != bitboard(0) && !(epCapt & targetMask))
             return;
 
+        // Removing two pieces from a rank can expose the king in ways the pin mask doesn't cover, so legal generation asks isLegal()
         Bitboard leftEp = pAttacksLeft & epBB;
         if (leftEp) {
             Square target = popLSB(&leftEp);
             Square origin = target - Direction::UP_LEFT[board->stm];
-            moves.add(Move::makeEnpassant(origin, target));
+            Move move = Move::makeEnpassant(origin, target);
+            moves.addIf(move, !masks.legal || board->isLegal(move));
         }
         Bitboard rightEp = pAttacksRight & epBB;
         if (rightEp) {
             Square target = popLSB(&rightEp);
             Square origin = target - Direction::UP_RIGHT[board->stm];
-            moves.add(Move::makeEnpassant(origin, target));
+            Move move = Move::makeEnpassant(origin, target);
+            moves.addIf(move, !masks.legal || board->isLegal(move));
         }
     }
 }
 
 // For all pieces other than pawns
 template <Piece pieceType>
-void generatePiece(Board* board, MoveList& moves, bool captures, Bitboard targetMask) {
+void generatePiece(Board* board, MoveList& moves, bool captures, const MoveMasks& masks) {
     Bitboard blockedUs = board->byColor[board->stm];
     Bitboard blockedEnemy = board->byColor[1 - board->stm];
     Bitboard occupied = blockedUs | blockedEnemy;
+    Bitboard targetMask = pieceType == Piece::KING ? masks.kingTargets : masks.checkMask;
 
     // Decide whether only captures or only non-captures
     Bitboard mask;
@@ -155,8 +215,10 @@ void generatePiece(Board* board, MoveList& moves, bool captures, Bitboard target
     Bitboard pieces = board->byPiece[pieceType] & blockedUs;
     while (pieces) {
         Square piece = popLSB(&pieces);
-        Bitboard targets = pieceType == Piece::KNIGHT ? BB::KNIGHT_ATTACKS[piece] : pieceType == Piece::BISHOP ? getBishopMoves(piece, occupied) : pieceType == Piece::ROOK ? getRookMoves(piece, occupied) : pieceType == Piece::QUEEN ? (getRookMoves(piece, occupied) | getBishopMoves(piece, occupied)) : pieceType == Piece::KING ? BB::KING_ATTACKS[lsb(board->byPiece[Piece::KING] & board->byColor[board->stm])] : bitboard(0);
+        Bitboard targets = pieceType == Piece::KNIGHT ? BB::KNIGHT_ATTACKS[piece] : pieceType == Piece::BISHOP ? getBishopMoves(piece, occupied) : pieceType == Piece::ROOK ? getRookMoves(piece, occupied) : pieceType == Piece::QUEEN ? (getRookMoves(piece, occupied) | getBishopMoves(piece, occupied)) : pieceType == Piece::KING ? BB::KING_ATTACKS[masks.king] : bitboard(0);
         targets &= mask;
+        if (pieceType != Piece::KING && (masks.pinned & bitboard(piece)))
+            targets &= BB::LINE[masks.king][piece];
 
         while (targets) {
             Square target = popLSB(&targets);
@@ -165,14 +227,14 @@ void generatePiece(Board* board, MoveList& moves, bool captures, Bitboard target
     }
 }
 
-void generateCastling(Board* board, MoveList& moves) {
+void generateCastling(Board* board, MoveList& moves, const MoveMasks& masks) {
     assert((board->byPiece[Piece::KING] & board->byColor[board->stm]) > 0);
 
-    Square king = lsb(board->byPiece[Piece::KING] & board->byColor[board->stm]);
+    Square king = masks.king;
     Bitboard occupied = board->byColor[Color::WHITE] | board->byColor[Color::BLACK];
 
     // Castling: Nothing on the squares between king and rook
-    // Checking if we are in check, or there are attacks in the way is done later (see isLegal())
+    // For pseudo-legal generation, checking if there are attacks in the way is done later (see isLegal())
     for (auto direction : { Castling::KINGSIDE, Castling::QUEENSIDE }) {
         if (board->castling & Castling::getMask(board->stm, direction)) {
             Square rookOrigin = board->getCastlingRookSquare(board->stm, direction);
@@ -181,49 +243,81 @@ void generateCastling(Board* board, MoveList& moves) {
 
             Bitboard between = BB::BETWEEN[rookOrigin][rookTarget] | BB::BETWEEN[king][kingTarget];
             between &= ~bitboard(rookOrigin) & ~bitboard(king);
-            if (!(occupied & between)) {
-                moves.add(Move::makeCastling(king, rookOrigin));
-            }
+            if (occupied & between)
+                continue;
+
+            if (masks.legal && ((BB::BETWEEN[king][kingTarget] & ~masks.kingTargets) || (board->blockers[board->stm] & bitboard(rookOrigin))))
+                continue;
+
+            moves.add(Move::makeCastling(king, rookOrigin));
         }
     }
 }
 
-void generateMoves(Board* board, MoveList& moves, bool onlyCaptures) {
-    assert((board->byColor[board->stm] & board->byPiece[Piece::KING]) > 0);
-
+void generateCaptures(Board* board, MoveList& moves, const MoveMasks& masks) {
     // If in double check, only generate king moves
     if (board->checkerCount > 1) {
-        generatePiece<Piece::KING>(board, moves, true, ~bitboard(0));
-        if (!onlyCaptures)
-            generatePiece<Piece::KING>(board, moves, false, ~bitboard(0));
+        generatePiece<Piece::KING>(board, moves, true, masks);
         return;
     }
 
-    // If in check, only generate targets that take care of the check
-    Bitboard checkMask = board->checkers ? BB::BETWEEN[lsb(board->byColor[board->stm] & board->byPiece[Piece::KING])][lsb(board->checkers)] : ~bitboard(0);
-
-    // ------------------- CAPTURES ----------------------
-    generatePawn_capture(board, moves, checkMask);
-    generatePiece<Piece::KNIGHT>(board, moves, true, checkMask);
-    generatePiece<Piece::BISHOP>(board, moves, true, checkMask);
-    generatePiece<Piece::ROOK>(board, moves, true, checkMask);
-    generatePiece<Piece::QUEEN>(board, moves, true, checkMask);
-    generatePiece<Piece::KING>(board, moves, true, ~bitboard(0));
-
-    // ------------------- NON CAPTURES ----------------------
-    if (!onlyCaptures) {
-        generatePawn_quiet(board, moves, checkMask);
-        generatePiece<Piece::KNIGHT>(board, moves, false, checkMask);
-        generatePiece<Piece::BISHOP>(board, moves, false, checkMask);
-        generatePiece<Piece::ROOK>(board, moves, false, checkMask);
-        generatePiece<Piece::QUEEN>(board, moves, false, checkMask);
-        generatePiece<Piece::KING>(board, moves, false, ~bitboard(0));
+    generatePawn_capture(board, moves, masks);
+    generatePiece<Piece::KNIGHT>(board, moves, true, masks);
+    generatePiece<Piece::BISHOP>(board, moves, true, masks);
+    generatePiece<Piece::ROOK>(board, moves, true, masks);
+    generatePiece<Piece::QUEEN>(board, moves, true, masks);
+    generatePiece<Piece::KING>(board, moves, true, masks);
+}
+
+void generateQuiets(Board* board, MoveList& moves, const MoveMasks& masks) {
+    // If in double check, only generate king moves
+    if (board->checkerCount > 1) {
+        generatePiece<Piece::KING>(board, moves, false, masks);
+        return;
     }
 
-    // ------------------- CASTLING ----------------------
-    if (!onlyCaptures && !board->checkers) {
-        generateCastling(board, moves);
+    generatePawn_quiet(board, moves, masks);
+    generatePiece<Piece::KNIGHT>(board, moves, false, masks);
+    generatePiece<Piece::BISHOP>(board, moves, false, masks);
+    generatePiece<Piece::ROOK>(board, moves, false, masks);
+    generatePiece<Piece::QUEEN>(board, moves, false, masks);
+    generatePiece<Piece::KING>(board, moves, false, masks);
+
+    if (!board->checkers)
+        generateCastling(board, moves, masks);
+}
+
+void generateMoves(Board* board, MoveList& moves, bool onlyCaptures) {
+    assert((board->byColor[board->stm] & board->byPiece[Piece::KING]) > 0);
+
+    MoveMasks masks = pseudoLegalMasks(board);
+    generateCaptures(board, moves, masks);
+    if (!onlyCaptures)
+        generateQuiets(board, moves, masks);
+}
+
+void generateLegalMoves(Board* board, MoveList& moves, bool onlyCaptures) {
+    assert((board->byColor[board->stm] & board->byPiece[Piece::KING]) > 0);
+
+    if (board->checkers) {
+        generateEvasions(board, moves, onlyCaptures);
+        return;
     }
+
+    MoveMasks masks = legalMasks(board);
+    generateCaptures(board, moves, masks);
+    if (!onlyCaptures)
+        generateQuiets(board, moves, masks);
+}
+
+void generateEvasions(Board* board, MoveList& moves, bool onlyCaptures) {
+    assert(board->checkers);
+
+    // Only the king moves in double check, otherwise pieces capture the checker or block its ray
+    MoveMasks masks = legalMasks(board);
+    generateCaptures(board, moves, masks);
+    if (!onlyCaptures)
+        generateQuiets(board, moves, masks);
 }
 
 // Main search
@@ -259,21 +353,7 @@ Move MoveGen::nextMove() {
         [[fallthrough]];
 
     case STAGE_GEN_CAPTURES:
-        // If in double check, only generate king moves
-        if (board->checkerCount > 1) {
-            generatePiece<Piece::KING>(board, moveList, true, ~bitboard(0));
-        }
-        else {
-            // If in check, only generate targets that take care of the check
-            Bitboard checkMask = board->checkers ? BB::BETWEEN[lsb(board->byColor[board->stm] & board->byPiece[Piece::KING])][lsb(board->checkers)] : ~bitboard(0);
-
-            generatePawn_capture(board, moveList, checkMask);
-            generatePiece<Piece::KNIGHT>(board, moveList, true, checkMask);
-            generatePiece<Piece::BISHOP>(board, moveList, true, checkMask);
-            generatePiece<Piece::ROOK>(board, moveList, true, checkMask);
-            generatePiece<Piece::QUEEN>(board, moveList, true, checkMask);
-            generatePiece<Piece::KING>(board, moveList, true, ~bitboard(0));
-        }
+        generateCaptures(board, moveList, pseudoLegalMasks(board));
 
         scoreCaptures();
         sortMoves();
@@ -320,34 +400,28 @@ Move MoveGen::nextMove() {
         [[fallthrough]];
 
     case STAGE_GEN_QUIETS:
-        // If in double check, only generate king moves
-        if (board->checkerCount > 1) {
-            generatePiece<Piece::KING>(board, moveList, false, ~bitboard(0));
-        }
-        else {
-            // If in check, only generate targets that take care of the check
-            Bitboard checkMask = board->checkers ? BB::BETWEEN[lsb(board->byColor[board->stm] & board->byPiece[Piece::KING])][lsb(board->checkers)] : ~bitboard(0);
-
-            generatePawn_quiet(board, moveList, checkMask);
-            generatePiece<Piece::KNIGHT>(board, moveList, false, checkMask);
-            generatePiece<Piece::BISHOP>(board, moveList, false, checkMask);
-            generatePiece<Piece::ROOK>(board, moveList, false, checkMask);
-            generatePiece<Piece::QUEEN>(board, moveList, false, checkMask);
-            generatePiece<Piece::KING>(board, moveList, false, ~bitboard(0));
-            if (!board->checkers)
-                generateCastling(board, moveList);
-        }
+        generateQuiets(board, moveList, pseudoLegalMasks(board));
 
         scoreQuiets();
-        sortMoves();
+        firstQuiet = returnedMoves;
+        history->quietOrderingStats.scored += moveList.size() - firstQuiet;
 
         ++stage;
         [[fallthrough]];
 
     case STAGE_PLAY_QUIETS:
 
-        if (returnedMoves < moveList.size())
+        if (returnedMoves < moveList.size()) {
+            // Most cut nodes fail high on one of the first quiets, so those are selected one by one and the rest is only sorted when it is needed
+            int selectedQuiets = returnedMoves - firstQuiet;
+            if (selectedQuiets < QUIET_SELECTIONS)
+                selectBestMove();
+            else if (selectedQuiets == QUIET_SELECTIONS)
+                sortMoves();
+
+            history->quietOrderingStats.returned++;
             return moveList[returnedMoves++];
+        }
 
         ++stage;
         [[fallthrough]];
@@ -395,7 +469,7 @@ void MoveGen::scoreCaptures() {
 }
 
 void MoveGen::scoreQuiets() {
-    Threats& threats = board->threats;
+    Threats& threats = board->getThreats();
 
     for (int i = returnedMoves; i < moveList.size(); i++) {
         Move move = moveList[i];
@@ -434,7 +508,7 @@ void MoveGen::scoreQuiets() {
 }
 
 void MoveGen::sortMoves() {
-    int limit = -3500 * depth;
+    int limit = sortLimit();
     for (int i = returnedMoves + 1; i < moveList.size(); i++) {
         if (moveListScores[i] < limit)
             continue;
@@ -454,6 +528,26 @@ void MoveGen::sortMoves() {
     }
 }
 
+// Moves the next move in the order of sortMoves() to the front: the best one with a score of at least the limit, otherwise the first remaining one
+void MoveGen::selectBestMove() {
+    int limit = sortLimit();
+    int best = returnedMoves;
+    for (int i = returnedMoves + 1; i < moveList.size(); i++) {
+        if (moveListScores[i] > moveListScores[best] && moveListScores[i] >= limit)
+            best = i;
+    }
+
+    // Shift instead of swapping, so the remaining moves keep their order for sortMoves()
+    Move move = moveList[best];
+    int score = moveListScores[best];
+    for (int i = best; i > returnedMoves; i--) {
+        moveList[i] = moveList[i - 1];
+        moveListScores[i] = moveListScores[i - 1];
+    }
+    moveList[returnedMoves] = move;
+    moveListScores[returnedMoves] = score;
+}
+
 Square stringToSquare(const char* string) {
     int file = string[0] - 'a';
     int rank = string[1] - '1';
@@ -483,7 +577,8 @@ Move stringToMove(const char* string, Board* board) {
         if (board->chess960 && board->pieces[origin] == Piece::KING && board->pieces[target] == Piece::ROOK && !(bitboard(target) & board->byColor[1 - board->stm]))
             move = Move::makeCastling(origin, target);
         else if (!board->chess960 && board->pieces[origin] == Piece::KING && std::abs(target - origin) == 2)
-            move = Move::makeCastling(origin, target);
+            // Castling moves are generated with the rook as the target, also outside of chess960
+            move = Move::makeCastling(origin, board->getCastlingRookSquare(board->stm, Castling::getDirection(origin, target)));
         else if (board->pieces[origin] == Piece::PAWN && board->pieces[target] == Piece::NONE && (std::abs(target - origin) == 7 || std::abs(target - origin) == 9))
             move = Move::makeEnpassant(origin, target);
         else
@@ -11,6 +11,10 @@ class History;
 using MoveList = ArrayVec<Move, MAX_MOVES>;
 
 void generateMoves(Board* board, MoveList& moves, bool onlyCaptures = false);
+// Only legal moves, using the pin and check masks of the board instead of Board::isLegal() per move
+void generateLegalMoves(Board* board, MoveList& moves, bool onlyCaptures = false);
+// Legal moves out of check
+void generateEvasions(Board* board, MoveList& moves, bool onlyCaptures = false);
 
 Square stringToSquare(const char* string);
 Move stringToMove(const char* string, Board* board);
@@ -46,6 +50,7 @@ public:
     MoveList moveList;
     ArrayVec<int, MAX_MOVES> moveListScores;
     int returnedMoves;
+    int firstQuiet;
 
     MoveList badCaptureList;
     int returnedBadCaptures;
@@ -77,6 +82,10 @@ private:
     void scoreCaptures();
     void scoreQuiets();
 
+    int sortLimit() {
+        return -3500 * depth;
+    }
     void sortMoves();
+    void selectBestMove();
 
 };
\ No newline at end of file
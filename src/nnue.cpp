@@ -31,24 +31,164 @@ INCBIN(NETWORK, EVALFILE);
 #endif
 
 NetworkData* globalNetworkData;
-alignas(ALIGNMENT) uint16_t nnzLookup[256][8];
+alignas(ALIGNMENT) constexpr auto nnzLookup = [] {
+    std::array<std::array<uint16_t, 8>, 256> table{};
+    for (size_t i = 0; i < 256; i++) {
+        uint64_t j = i;
+        uint64_t k = 0;
+        while (j) {
+            table[i][k++] = __builtin_ctzll(j);
+            j &= j - 1;
+        }
+    }
+    return table;
+}();
 
 #if defined(PROCESS_NET)
 NNZ nnz;
 #endif
 
 void initNetworkData() {
-    ThreatInputs::initialise();
+    globalNetworkData = (NetworkData*)gNETWORKData;
+}
 
-    for (size_t i = 0; i < 256; i++) {
-        uint64_t j = i;
-        uint64_t k = 0;
-        while (j) {
-            nnzLookup[i][k++] = popLSB(&j);
+void NNZProfile::add(int bucket, uint8_t* pairwiseOutputs) {
+    evaluations[bucket]++;
+    for (int i = 0; i < L1_SIZE; i += INT8_PER_INT32) {
+        bool nonZero = false;
+        for (int j = i; j < i + INT8_PER_INT32; j++) {
+            activations[bucket][j] += pairwiseOutputs[j] != 0;
+            nonZero |= pairwiseOutputs[j] != 0;
         }
+        nonZeroChunks[bucket] += nonZero;
     }
+}
 
-    globalNetworkData = (NetworkData*)gNETWORKData;
+void NNZProfile::merge(const NNZProfile& other) {
+    for (int b = 0; b < OUTPUT_BUCKETS; b++) {
+        evaluations[b] += other.evaluations[b];
+        nonZeroChunks[b] += other.nonZeroChunks[b];
+        for (int i = 0; i < L1_SIZE; i++)
+            activations[b][i] += other.activations[b][i];
+    }
+}
+
+void NNZProfile::computeOrder(int* order) {
+    uint64_t total[L1_SIZE / 2] = {};
+    for (int b = 0; b < OUTPUT_BUCKETS; b++) {
+        for (int i = 0; i < L1_SIZE; i++)
+            total[i % (L1_SIZE / 2)] += activations[b][i];
+    }
+
+    for (int i = 0; i < L1_SIZE / 2; i++)
+        order[i] = i;
+    std::stable_sort(order, order + L1_SIZE / 2, [&](int a, int b) { return total[a] < total[b]; });
+}
+
+double NNZProfile::expectedNonZeroChunks(int bucket, const int* order) {
+    if (!evaluations[bucket])
+        return 0;
+
+    double expected = 0;
+    for (int half = 0; half < L1_SIZE; half += L1_SIZE / 2) {
+        for (int i = 0; i < L1_SIZE / 2; i += INT8_PER_INT32) {
+            double allZero = 1;
+            for (int j = i; j < i + INT8_PER_INT32; j++)
+                allZero *= 1 - double(activations[bucket][half + order[j]]) / evaluations[bucket];
+            expected += 1 - allZero;
+        }
+    }
+    return expected;
+}
+
+// Column of a neuron in the processed feature transformer, which is permuted to undo the lane interleaving of packus
+int featureTransformerColumn(int neuron) {
+#if (defined(__AVX512F__) && defined(__AVX512BW__))
+    constexpr int packusBlocks = 8;
+    constexpr int blockOfOutput[packusBlocks] = { 0, 4, 1, 5, 2, 6, 3, 7 };
+#elif defined(__AVX2__)
+    constexpr int packusBlocks = 4;
+    constexpr int blockOfOutput[packusBlocks] = { 0, 2, 1, 3 };
+#else
+    constexpr int packusBlocks = 1;
+    constexpr int blockOfOutput[packusBlocks] = { 0 };
+#endif
+    constexpr int weightsPerBlock = 16 / sizeof(int16_t);
+    int group = neuron / (weightsPerBlock * packusBlocks);
+    int block = neuron / weightsPerBlock % packusBlocks;
+    return (group * packusBlocks + blockOfOutput[block]) * weightsPerBlock + neuron % weightsPerBlock;
+}
+
+// Offset of an L1 input weight in the processed L1 weights of one bucket
+int l1WeightIndex(int input, int l2) {
+#if defined(__SSSE3__) || defined(__AVX2__) || (defined(__AVX512F__) && defined(__AVX512BW__)) || defined(ARCH_ARM)
+    return (input / INT8_PER_INT32) * INT8_PER_INT32 * L2_SIZE + l2 * INT8_PER_INT32 + input % INT8_PER_INT32;
+#else
+    return input * L2_SIZE + l2;
+#endif
+}
+
+template<typename T>
+void permuteFeatureTransformerRows(T* output, const T* input, int rows, const int* order) {
+    int columns[L1_SIZE / 2];
+    for (int i = 0; i < L1_SIZE / 2; i++)
+        columns[i] = featureTransformerColumn(i);
+
+    for (int64_t row = 0; row < rows; row++) {
+        const T* in = &input[row * L1_SIZE];
+        T* out = &output[row * L1_SIZE];
+        for (int i = 0; i < L1_SIZE / 2; i++) {
+            out[columns[i]] = in[columns[order[i]]];
+            out[columns[i] + L1_SIZE / 2] = in[columns[order[i]] + L1_SIZE / 2];
+        }
+    }
+}
+
+void permuteNetworkNeurons(NetworkData* output, const NetworkData* input, const int* order) {
+    memcpy(output, input, sizeof(NetworkData));
+
+    permuteFeatureTransformerRows(output->inputPsqWeights, input->inputPsqWeights, 768 * KING_BUCKETS, order);
+    permuteFeatureTransformerRows(output->inputThreatWeights, input->inputThreatWeights, ThreatInputs::PAWN_PAIR_FEATURE_COUNT + ThreatInputs::FEATURE_COUNT, order);
+    permuteFeatureTransformerRows(output->inputBiases, input->inputBiases, 1, order);
+
+    // Both perspectives feed the same neuron order into L1
+    for (int b = 0; b < OUTPUT_BUCKETS; b++) {
+        for (int half = 0; half < L1_SIZE; half += L1_SIZE / 2) {
+            for (int i = 0; i < L1_SIZE / 2; i++) {
+                for (int l2 = 0; l2 < L2_SIZE; l2++)
+                    output->l1Weights[b][l1WeightIndex(half + i, l2)] = input->l1Weights[b][l1WeightIndex(half + order[i], l2)];
+            }
+        }
+    }
+}
+
+// Applies all rows to one tile of the accumulator held in registers
+template<FtType type, typename List>
+__always_inline void applyRowsToTile(NetworkData* networkData, VecI16* registers, int base, const List& adds, const List& subs) {
+    for (int feature : subs) {
+        if constexpr (type == FtType::Psq) {
+            VecI16* weights = (VecI16*)&networkData->inputPsqWeights[feature * L1_SIZE];
+            for (int t = 0; t < ACCUMULATOR_TILE; t++)
+                registers[t] = subEpi16(registers[t], weights[base + t]);
+        }
+        else {
+            VecI16s* weights = (VecI16s*)&networkData->inputThreatWeights[feature * L1_SIZE];
+            for (int t = 0; t < ACCUMULATOR_TILE; t++)
+                registers[t] = subEpi16(registers[t], convertEpi8Epi16(weights[base + t]));
+        }
+    }
+    for (int feature : adds) {
+        if constexpr (type == FtType::Psq) {
+            VecI16* weights = (VecI16*)&networkData->inputPsqWeights[feature * L1_SIZE];
+            for (int t = 0; t < ACCUMULATOR_TILE; t++)
+                registers[t] = addEpi16(registers[t], weights[base + t]);
+        }
+        else {
+            VecI16s* weights = (VecI16s*)&networkData->inputThreatWeights[feature * L1_SIZE];
+            for (int t = 0; t < ACCUMULATOR_TILE; t++)
+                registers[t] = addEpi16(registers[t], convertEpi8Epi16(weights[base + t]));
+        }
+    }
 }
 
 void NNUE::reset(Board* board) {
@@ -75,6 +215,10 @@ void NNUE::reset(Board* board) {
             memset(finnyTable[i][j].pieceState[Color::WHITE], 0, sizeof(networkData->inputBiases));
             memset(finnyTable[i][j].pieceState[Color::BLACK], 0, sizeof(networkData->inputBiases));
         }
+        for (Color side = Color::WHITE; side <= Color::BLACK; ++side) {
+            memcpy(threatFinnyTable[i].threatState[side], networkData->inputBiases, sizeof(networkData->inputBiases));
+            threatFinnyTable[i].features[side] = ThreatInputs::FeatureList{};
+        }
     }
 }
 
@@ -88,12 +232,11 @@ void NNUE::resetAccumulator(Board* board, Accumulator* acc) {
     ThreatInputs::FeatureList threatFeatures;
     ThreatInputs::addThreatFeatures<side>(board, threatFeatures);
     ThreatInputs::addPawnPairFeatures<side>(board, threatFeatures);
-    applyThreatRows<side>(acc->threatState, acc->threatState, threatFeatures, ThreatInputs::FeatureList{});
+    applyRows<FtType::Threat, side>(acc->threatState, acc->threatState, threatFeatures, ThreatInputs::FeatureList{});
 
     ThreatInputs::FeatureList pieceFeatures;
     ThreatInputs::addPieceFeatures(board, side, pieceFeatures, KING_BUCKET_LAYOUT);
-    for (int featureIndex : pieceFeatures)
-        addToAccumulator<FtType::Psq, side>(acc->pieceState, acc->pieceState, featureIndex);
+    applyRows<FtType::Psq, side>(acc->pieceState, acc->pieceState, pieceFeatures, ThreatInputs::FeatureList{});
 
     acc->kingBucketInfo[side] = getKingBucket(side, lsb(board->byColor[side] & board->byPiece[Piece::KING]));;
     acc->board = board;
@@ -111,16 +254,14 @@ void NNUE::updateThreat(Piece piece, Piece attackedPiece, Square square, Square
         acc->dirtyThreatsRemoved[acc->numThreatsRemoved++] = threat;
 }
 
-#if defined(__AVX512VBMI2__)
+#if defined(__AVX512VBMI2__) || defined(__AVX2__)
 template<bool add, bool computeRays>
 void NNUE::updatePieceThreatsGeometry(Board* board, Piece piece, Color pieceColor, Square square, Square ignore) {
     using namespace ThreatGeometry;
     Accumulator* acc = &accumulatorStack[currentAccumulator];
     uint8_t colouredPiece = static_cast<uint8_t>(piece | (pieceColor << 3));
 
-    __m512i mailbox = colouredMailbox((const uint8_t*)board->pieces, board->byColor[Color::BLACK]);
-    if (ignore != NO_SQUARE)
-        mailbox = _mm512_mask_blend_epi8(1ULL << ignore, mailbox, _mm512_set1_epi8(Piece::NONE));
+    auto mailbox = colouredMailbox((const uint8_t*)board->pieces, board->byColor[Color::BLACK], ignore);
     Permutation perm = permutationFor(square);
     auto [permuted, bits] = permuteMailbox(perm, mailbox);
     Bitrays closest = closestOccupied(bits);
@@ -171,6 +312,11 @@ void NNUE::finalizeMove(Board* board, DirtyPiece dirtyPiece) {
 
 template<Color side>
 void NNUE::calculateAccumulators() {
+    if (currentAccumulator - lastCalculatedAccumulator[side] > 1 && canFuseUpdates<side>()) {
+        fusedUpdateAccumulators<side>();
+        return;
+    }
+
     // Incrementally update all accumulators for this side
     while (lastCalculatedAccumulator[side] < currentAccumulator) {
 
@@ -181,7 +327,7 @@ void NNUE::calculateAccumulators() {
         KingBucketInfo* outputKingBucket = &outputAcc->kingBucketInfo[side];
 
         if (inputKingBucket->mirrored != outputKingBucket->mirrored)
-            refreshThreatFeatures<side>(outputAcc);
+            refreshThreatFeatures<side>(outputAcc, outputKingBucket);
         else
             incrementallyUpdateThreatFeatures<side>(inputAcc, outputAcc, outputKingBucket);
 
@@ -194,11 +340,96 @@ void NNUE::calculateAccumulators() {
     }
 }
 
+template<Color side>
+bool NNUE::canFuseUpdates() {
+    if (currentAccumulator - lastCalculatedAccumulator[side] > MAX_FUSED_PLIES)
+        return false;
+
+    // Refreshes can't be merged with incremental updates
+    KingBucketInfo* baseKingBucket = &accumulatorStack[lastCalculatedAccumulator[side]].kingBucketInfo[side];
+    for (int i = lastCalculatedAccumulator[side] + 1; i <= currentAccumulator; i++) {
+        KingBucketInfo* kingBucket = &accumulatorStack[i].kingBucketInfo[side];
+        if (kingBucket->bucket != baseKingBucket->bucket || kingBucket->mirrored != baseKingBucket->mirrored)
+            return false;
+    }
+    return true;
+}
+
+// Drops features that are both added and removed
+template<typename List>
+int cancelDeltas(List& adds, List& subs) {
+    int cancelled = 0;
+    for (int i = 0; i < adds.size(); i++) {
+        for (int j = 0; j < subs.size(); j++) {
+            if (adds[i] == subs[j]) {
+                adds.remove(i--);
+                subs.remove(j);
+                cancelled += 2;
+                break;
+            }
+        }
+    }
+    return cancelled;
+}
+
+template<Color side>
+void NNUE::fusedUpdateAccumulators() {
+    int firstAccumulator = lastCalculatedAccumulator[side] + 1;
+    int plies = currentAccumulator - lastCalculatedAccumulator[side];
+    KingBucketInfo* kingBucket = &accumulatorStack[currentAccumulator].kingBucketInfo[side];
+
+    ThreatInputs::FeatureList threatAdds[MAX_FUSED_PLIES], threatSubs[MAX_FUSED_PLIES];
+    PieceDeltaList pieceAdds[MAX_FUSED_PLIES], pieceSubs[MAX_FUSED_PLIES];
+    for (int p = 0; p < plies; p++) {
+        Accumulator* acc = &accumulatorStack[firstAccumulator + p];
+        ThreatInputs::addPawnPairDeltas<side>(acc->board, acc->dirtyPiece, kingBucket->mirrored, threatAdds[p], threatSubs[p]);
+        addDirtyThreatDeltas<side>(acc, kingBucket, threatAdds[p], threatSubs[p]);
+        addPieceDeltas<side>(acc->dirtyPiece, kingBucket, pieceAdds[p], pieceSubs[p]);
+
+        fusedUpdateStats.rowsCancelled += cancelDeltas(threatAdds[p], threatSubs[p]);
+        fusedUpdateStats.rowsApplied += threatAdds[p].size() + threatSubs[p].size() + pieceAdds[p].size() + pieceSubs[p].size();
+    }
+    fusedUpdateStats.updates++;
+    fusedUpdateStats.plies += plies;
+
+    // Each tile stays in registers while the rows of all plies are applied, storing it once per ply
+    for (int base = 0; base < L1_ITERATIONS; base += ACCUMULATOR_TILE) {
+        VecI16 registers[ACCUMULATOR_TILE];
+
+        VecI16* threatInput = (VecI16*)accumulatorStack[firstAccumulator - 1].threatState[side];
+        for (int t = 0; t < ACCUMULATOR_TILE; t++)
+            registers[t] = threatInput[base + t];
+
+        for (int p = 0; p < plies; p++) {
+            applyRowsToTile<FtType::Threat>(networkData, registers, base, threatAdds[p], threatSubs[p]);
+
+            VecI16* threatOutput = (VecI16*)accumulatorStack[firstAccumulator + p].threatState[side];
+            for (int t = 0; t < ACCUMULATOR_TILE; t++)
+                threatOutput[base + t] = registers[t];
+        }
+
+        VecI16* pieceInput = (VecI16*)accumulatorStack[firstAccumulator - 1].pieceState[side];
+        for (int t = 0; t < ACCUMULATOR_TILE; t++)
+            registers[t] = pieceInput[base + t];
+
+        for (int p = 0; p < plies; p++) {
+            applyRowsToTile<FtType::Psq>(networkData, registers, base, pieceAdds[p], pieceSubs[p]);
+
+            VecI16* pieceOutput = (VecI16*)accumulatorStack[firstAccumulator + p].pieceState[side];
+            for (int t = 0; t < ACCUMULATOR_TILE; t++)
+                pieceOutput[base + t] = registers[t];
+        }
+    }
+
+    lastCalculatedAccumulator[side] = currentAccumulator;
+}
+
 template<Color side>
 void NNUE::refreshPieceFeatures(Accumulator* acc, KingBucketInfo* kingBucket) {
     FinnyEntry* finnyEntry = &finnyTable[kingBucket->mirrored][kingBucket->bucket];
 
     // Update matching finny table with the changed pieces
+    ThreatInputs::FeatureList adds, subs;
     for (Color c = Color::WHITE; c <= Color::BLACK; ++c) {
         for (Piece p = Piece::PAWN; p < Piece::TOTAL; ++p) {
             Bitboard finnyBB = finnyEntry->byColor[side][c] & finnyEntry->byPiece[side][p];
@@ -209,16 +440,15 @@ void NNUE::refreshPieceFeatures(Accumulator* acc, KingBucketInfo* kingBucket) {
 
             while (addBB) {
                 Square square = popLSB(&addBB);
-                int featureIndex = ThreatInputs::getPieceFeature(p, square ^ (side * 56) ^ (kingBucket->mirrored * 7), static_cast<Color>(c != side), kingBucket->bucket);
-                addToAccumulator<FtType::Psq, side>(finnyEntry->pieceState, finnyEntry->pieceState, featureIndex);
+                adds.add(ThreatInputs::getPieceFeature(p, square ^ (side * 56) ^ (kingBucket->mirrored * 7), static_cast<Color>(c != side), kingBucket->bucket));
             }
             while (removeBB) {
                 Square square = popLSB(&removeBB);
-                int featureIndex = ThreatInputs::getPieceFeature(p, square ^ (side * 56) ^ (kingBucket->mirrored * 7), static_cast<Color>(c != side), kingBucket->bucket);
-                subFromAccumulator<FtType::Psq, side>(finnyEntry->pieceState, finnyEntry->pieceState, featureIndex);
+                subs.add(ThreatInputs::getPieceFeature(p, square ^ (side * 56) ^ (kingBucket->mirrored * 7), static_cast<Color>(c != side), kingBucket->bucket));
             }
         }
     }
+    applyRows<FtType::Psq, side>(finnyEntry->pieceState, finnyEntry->pieceState, adds, subs);
     memcpy(finnyEntry->byColor[side], acc->board->byColor, sizeof(finnyEntry->byColor[side]));
     memcpy(finnyEntry->byPiece[side], acc->board->byPiece, sizeof(finnyEntry->byPiece[side]));
 
@@ -227,216 +457,162 @@ void NNUE::refreshPieceFeatures(Accumulator* acc, KingBucketInfo* kingBucket) {
 }
 
 template<Color side>
-void NNUE::refreshThreatFeatures(Accumulator* acc) {
-    // Overwrite with biases
-    memcpy(acc->threatState[side], networkData->inputBiases, sizeof(networkData->inputBiases));
+void NNUE::refreshThreatFeatures(Accumulator* acc, KingBucketInfo* kingBucket) {
+    ThreatFinnyEntry* finnyEntry = &threatFinnyTable[kingBucket->mirrored];
 
     ThreatInputs::FeatureList threatFeatures;
     ThreatInputs::addThreatFeatures<side>(acc->board, threatFeatures);
     ThreatInputs::addPawnPairFeatures<side>(acc->board, threatFeatures);
-    applyThreatRows<side>(acc->threatState, acc->threatState, threatFeatures, ThreatInputs::FeatureList{});
+    std::sort(threatFeatures.begin(), threatFeatures.end());
+
+    // Diff against the features the finny entry was last built from (both lists are sorted)
+    ThreatInputs::FeatureList& cachedFeatures = finnyEntry->features[side];
+    ThreatInputs::FeatureList adds, subs;
+    int i = 0, j = 0;
+    while (i < threatFeatures.size() && j < cachedFeatures.size()) {
+        if (threatFeatures[i] < cachedFeatures[j])
+            adds.add(threatFeatures[i++]);
+        else if (threatFeatures[i] > cachedFeatures[j])
+            subs.add(cachedFeatures[j++]);
+        else {
+            i++;
+            j++;
+        }
+    }
+    while (i < threatFeatures.size())
+        adds.add(threatFeatures[i++]);
+    while (j < cachedFeatures.size())
+        subs.add(cachedFeatures[j++]);
+
+    // Rebuild from the biases instead if that touches fewer weight rows
+    if (adds.size() + subs.size() <= threatFeatures.size()) {
+        applyRows<FtType::Threat, side>(finnyEntry->threatState, finnyEntry->threatState, adds, subs);
+        threatRefreshStats.rowsApplied += adds.size() + subs.size();
+    }
+    else {
+        memcpy(finnyEntry->threatState[side], networkData->inputBiases, sizeof(networkData->inputBiases));
+        applyRows<FtType::Threat, side>(finnyEntry->threatState, finnyEntry->threatState, threatFeatures, ThreatInputs::FeatureList{});
+        threatRefreshStats.rowsApplied += threatFeatures.size();
+    }
+    threatRefreshStats.refreshes++;
+    threatRefreshStats.rowsFromScratch += threatFeatures.size();
+    cachedFeatures = threatFeatures;
+
+    // Copy result to the current accumulator
+    memcpy(acc->threatState[side], finnyEntry->threatState[side], sizeof(acc->threatState[side]));
 }
 
 template<Color side>
-void NNUE::incrementallyUpdatePieceFeatures(Accumulator* inputAcc, Accumulator* outputAcc, KingBucketInfo* kingBucket) {
-
+void NNUE::addPieceDeltas(DirtyPiece& dirtyPiece, KingBucketInfo* kingBucket, PieceDeltaList& adds, PieceDeltaList& subs) {
     Square squareFlip = (56 * side) ^ (7 * kingBucket->mirrored);
-    DirtyPiece& dirtyPiece = outputAcc->dirtyPiece;
     Color color = static_cast<Color>(dirtyPiece.pieceColor != side);
 
     // Promotion
     if (dirtyPiece.target == NO_SQUARE) {
-        int sub1 = ThreatInputs::getPieceFeature(dirtyPiece.piece, dirtyPiece.origin ^ squareFlip, color, kingBucket->bucket);
-        int add1 = ThreatInputs::getPieceFeature(dirtyPiece.addPiece, dirtyPiece.addSquare ^ squareFlip, color, kingBucket->bucket);
-        addSubToAccumulator<FtType::Psq, side>(inputAcc->pieceState, outputAcc->pieceState, add1, sub1);
+        subs.add(ThreatInputs::getPieceFeature(dirtyPiece.piece, dirtyPiece.origin ^ squareFlip, color, kingBucket->bucket));
+        adds.add(ThreatInputs::getPieceFeature(dirtyPiece.addPiece, dirtyPiece.addSquare ^ squareFlip, color, kingBucket->bucket));
 
         if (dirtyPiece.removeSquare != NO_SQUARE) {
             // Promotion capture
-            int sub2 = ThreatInputs::getPieceFeature(dirtyPiece.removePiece, dirtyPiece.removeSquare ^ squareFlip, flip(color), kingBucket->bucket);
-            subFromAccumulator<FtType::Psq, side>(outputAcc->pieceState, outputAcc->pieceState, sub2);
+            subs.add(ThreatInputs::getPieceFeature(dirtyPiece.removePiece, dirtyPiece.removeSquare ^ squareFlip, flip(color), kingBucket->bucket));
         }
     }
     // Castling
     else if (dirtyPiece.addSquare != NO_SQUARE) {
-        int sub1 = ThreatInputs::getPieceFeature(Piece::KING, dirtyPiece.origin ^ squareFlip, color, kingBucket->bucket);
-        int add1 = ThreatInputs::getPieceFeature(Piece::KING, dirtyPiece.target ^ squareFlip, color, kingBucket->bucket);
-        int sub2 = ThreatInputs::getPieceFeature(Piece::ROOK, dirtyPiece.removeSquare ^ squareFlip, color, kingBucket->bucket);
-        int add2 = ThreatInputs::getPieceFeature(Piece::ROOK, dirtyPiece.addSquare ^ squareFlip, color, kingBucket->bucket);
-        addSubToAccumulator<FtType::Psq, side>(inputAcc->pieceState, outputAcc->pieceState, add1, sub1);
-        addSubToAccumulator<FtType::Psq, side>(outputAcc->pieceState, outputAcc->pieceState, add2, sub2);
+        subs.add(ThreatInputs::getPieceFeature(Piece::KING, dirtyPiece.origin ^ squareFlip, color, kingBucket->bucket));
+        adds.add(ThreatInputs::getPieceFeature(Piece::KING, dirtyPiece.target ^ squareFlip, color, kingBucket->bucket));
+        subs.add(ThreatInputs::getPieceFeature(Piece::ROOK, dirtyPiece.removeSquare ^ squareFlip, color, kingBucket->bucket));
+        adds.add(ThreatInputs::getPieceFeature(Piece::ROOK, dirtyPiece.addSquare ^ squareFlip, color, kingBucket->bucket));
     }
     // Other
     else {
-        int sub1 = ThreatInputs::getPieceFeature(dirtyPiece.piece, dirtyPiece.origin ^ squareFlip, color, kingBucket->bucket);
-        int add1 = ThreatInputs::getPieceFeature(dirtyPiece.piece, dirtyPiece.target ^ squareFlip, color, kingBucket->bucket);
-        addSubToAccumulator<FtType::Psq, side>(inputAcc->pieceState, outputAcc->pieceState, add1, sub1);
+        subs.add(ThreatInputs::getPieceFeature(dirtyPiece.piece, dirtyPiece.origin ^ squareFlip, color, kingBucket->bucket));
+        adds.add(ThreatInputs::getPieceFeature(dirtyPiece.piece, dirtyPiece.target ^ squareFlip, color, kingBucket->bucket));
 
         if (dirtyPiece.removeSquare != NO_SQUARE) {
             // Capture / EP
-            int sub2 = ThreatInputs::getPieceFeature(dirtyPiece.removePiece, dirtyPiece.removeSquare ^ squareFlip, flip(color), kingBucket->bucket);
-            subFromAccumulator<FtType::Psq, side>(outputAcc->pieceState, outputAcc->pieceState, sub2);
+            subs.add(ThreatInputs::getPieceFeature(dirtyPiece.removePiece, dirtyPiece.removeSquare ^ squareFlip, flip(color), kingBucket->bucket));
         }
     }
 }
 
 template<Color side>
-void NNUE::incrementallyUpdateThreatFeatures(Accumulator* inputAcc, Accumulator* outputAcc, KingBucketInfo* kingBucket) {
-    ThreatInputs::FeatureList adds, subs;
-    ThreatInputs::addPawnPairDeltas<side>(outputAcc->board, outputAcc->dirtyPiece, kingBucket->mirrored, adds, subs);
+void NNUE::incrementallyUpdatePieceFeatures(Accumulator* inputAcc, Accumulator* outputAcc, KingBucketInfo* kingBucket) {
+    PieceDeltaList adds, subs;
+    addPieceDeltas<side>(outputAcc->dirtyPiece, kingBucket, adds, subs);
+    applyRows<FtType::Psq, side>(inputAcc->pieceState, outputAcc->pieceState, adds, subs);
+}
 
-    for (int dp = 0; dp < outputAcc->numThreatsAdded; dp++) {
-        DirtyThreat& dt = outputAcc->dirtyThreatsAdded[dp];
+template<Color side, typename List>
+void NNUE::addDirtyThreatDeltas(Accumulator* acc, KingBucketInfo* kingBucket, List& adds, List& subs) {
+    for (int dp = 0; dp < acc->numThreatsAdded; dp++) {
+        DirtyThreat& dt = acc->dirtyThreatsAdded[dp];
         int featureIndex = ThreatInputs::getThreatFeature<side>(dt.piece, dt.attackedPiece, dt.square, dt.attackedSquare, kingBucket->mirrored);
         __builtin_prefetch(&networkData->inputThreatWeights[(ThreatInputs::THREAT_OFFSET + featureIndex) * L1_SIZE]);
         adds.addIf(ThreatInputs::THREAT_OFFSET + featureIndex, featureIndex < ThreatInputs::FEATURE_COUNT);
     }
-    for (int dp = 0; dp < outputAcc->numThreatsRemoved; dp++) {
-        DirtyThreat& dt = outputAcc->dirtyThreatsRemoved[dp];
+    for (int dp = 0; dp < acc->numThreatsRemoved; dp++) {
+        DirtyThreat& dt = acc->dirtyThreatsRemoved[dp];
         int featureIndex = ThreatInputs::getThreatFeature<side>(dt.piece, dt.attackedPiece, dt.square, dt.attackedSquare, kingBucket->mirrored);
         __builtin_prefetch(&networkData->inputThreatWeights[(ThreatInputs::THREAT_OFFSET + featureIndex) * L1_SIZE]);
         subs.addIf(ThreatInputs::THREAT_OFFSET + featureIndex, featureIndex < ThreatInputs::FEATURE_COUNT);
     }
+}
+
+template<Color side>
+void NNUE::incrementallyUpdateThreatFeatures(Accumulator* inputAcc, Accumulator* outputAcc, KingBucketInfo* kingBucket) {
+    ThreatInputs::FeatureList adds, subs;
+    ThreatInputs::addPawnPairDeltas<side>(outputAcc->board, outputAcc->dirtyPiece, kingBucket->mirrored, adds, subs);
+    addDirtyThreatDeltas<side>(outputAcc, kingBucket, adds, subs);
 
     if (!adds.size() && !subs.size()) {
         memcpy(outputAcc->threatState[side], inputAcc->threatState[side], sizeof(networkData->inputBiases));
         return;
     }
 
-    applyThreatRows<side>(inputAcc->threatState, outputAcc->threatState, adds, subs);
-}
-
-template<FtType type, Color side>
-void NNUE::addToAccumulator(int16_t(*inputData)[L1_SIZE], int16_t(*outputData)[L1_SIZE], int featureIndex) {
-    VecI16* inputVec = (VecI16*)inputData[side];
-    VecI16* outputVec = (VecI16*)outputData[side];
-
-    if constexpr (type != FtType::Psq) {
-        int8_t* weights = networkData->inputThreatWeights;
-        VecI16s* weightsVec = (VecI16s*)&weights[featureIndex * L1_SIZE];
-
-        for (int i = 0; i < L1_ITERATIONS; ++i) {
-            VecI16 addWeights = convertEpi8Epi16(weightsVec[i]);
-            outputVec[i] = addEpi16(inputVec[i], addWeights);
-        }
-    }
-    else {
-        VecI16* weightsVec = (VecI16*)&networkData->inputPsqWeights[featureIndex * L1_SIZE];
-
-        for (int i = 0; i < L1_ITERATIONS; ++i) {
-            outputVec[i] = addEpi16(inputVec[i], weightsVec[i]);
-        }
-    }
-}
-
-template<FtType type, Color side>
-void NNUE::subFromAccumulator(int16_t(*inputData)[L1_SIZE], int16_t(*outputData)[L1_SIZE], int featureIndex) {
-    VecI16* inputVec = (VecI16*)inputData[side];
-    VecI16* outputVec = (VecI16*)outputData[side];
-
-    if constexpr (type != FtType::Psq) {
-        int8_t* weights = networkData->inputThreatWeights;
-        VecI16s* weightsVec = (VecI16s*)&weights[featureIndex * L1_SIZE];
-
-        for (int i = 0; i < L1_ITERATIONS; ++i) {
-            VecI16 addWeights = convertEpi8Epi16(weightsVec[i]);
-            outputVec[i] = subEpi16(inputVec[i], addWeights);
-        }
-    }
-    else {
-        VecI16* weightsVec = (VecI16*)&networkData->inputPsqWeights[featureIndex * L1_SIZE];
-
-        for (int i = 0; i < L1_ITERATIONS; ++i) {
-            outputVec[i] = subEpi16(inputVec[i], weightsVec[i]);
-        }
-    }
+    applyRows<FtType::Threat, side>(inputAcc->threatState, outputAcc->threatState, adds, subs);
 }
 
-template<FtType type, Color side>
-void NNUE::addSubToAccumulator(int16_t(*inputData)[L1_SIZE], int16_t(*outputData)[L1_SIZE], int addIndex, int subIndex) {
-    VecI16* inputVec = (VecI16*)inputData[side];
-    VecI16* outputVec = (VecI16*)outputData[side];
-
-    if constexpr (type != FtType::Psq) {
-        int8_t* weights = networkData->inputThreatWeights;
-        VecI16s* addWeightsVec = (VecI16s*)&weights[addIndex * L1_SIZE];
-        VecI16s* subWeightsVec = (VecI16s*)&weights[subIndex * L1_SIZE];
-
-        for (int i = 0; i < L1_ITERATIONS; ++i) {
-            VecI16 addWeights = convertEpi8Epi16(addWeightsVec[i]);
-            VecI16 subWeights = convertEpi8Epi16(subWeightsVec[i]);
-            outputVec[i] = subEpi16(addEpi16(inputVec[i], addWeights), subWeights);
-        }
-    }
-    else {
-        VecI16* addWeightsVec = (VecI16*)&networkData->inputPsqWeights[addIndex * L1_SIZE];
-        VecI16* subWeightsVec = (VecI16*)&networkData->inputPsqWeights[subIndex * L1_SIZE];
-
-        for (int i = 0; i < L1_ITERATIONS; ++i) {
-            outputVec[i] = subEpi16(addEpi16(inputVec[i], addWeightsVec[i]), subWeightsVec[i]);
-        }
-    }
-}
-
-template<Color side>
-void NNUE::applyThreatRows(int16_t(*inputData)[L1_SIZE], int16_t(*outputData)[L1_SIZE],
-                           const ThreatInputs::FeatureList& adds, const ThreatInputs::FeatureList& subs) {
+template<FtType type, Color side, typename List>
+void NNUE::applyRows(int16_t(*inputData)[L1_SIZE], int16_t(*outputData)[L1_SIZE], const List& adds, const List& subs) {
     VecI16* input = (VecI16*)inputData[side];
     VecI16* output = (VecI16*)outputData[side];
 
-#if defined(__AVX512F__) && defined(__AVX512BW__)
-    constexpr int TILE = L1_ITERATIONS >= 32 ? 16 : L1_ITERATIONS;
-#else
-    constexpr int TILE = 8;
-#endif
-    static_assert(L1_ITERATIONS % TILE == 0);
-
-    for (int base = 0; base < L1_ITERATIONS; base += TILE) {
-        VecI16 registers[TILE];
-        for (int t = 0; t < TILE; t++)
+    for (int base = 0; base < L1_ITERATIONS; base += ACCUMULATOR_TILE) {
+        VecI16 registers[ACCUMULATOR_TILE];
+        for (int t = 0; t < ACCUMULATOR_TILE; t++)
             registers[t] = input[base + t];
 
-        for (int feature : subs) {
-            VecI16s* weights = (VecI16s*)&networkData->inputThreatWeights[feature * L1_SIZE];
-            for (int t = 0; t < TILE; t++)
-                registers[t] = subEpi16(registers[t], convertEpi8Epi16(weights[base + t]));
-        }
-        for (int feature : adds) {
-            VecI16s* weights = (VecI16s*)&networkData->inputThreatWeights[feature * L1_SIZE];
-            for (int t = 0; t < TILE; t++)
-                registers[t] = addEpi16(registers[t], convertEpi8Epi16(weights[base + t]));
-        }
+        applyRowsToTile<type>(networkData, registers, base, adds, subs);
 
-        for (int t = 0; t < TILE; t++)
+        for (int t = 0; t < ACCUMULATOR_TILE; t++)
             output[base + t] = registers[t];
     }
 }
 
-Eval NNUE::evaluate(Board* board) {
-    // Make sure the current accumulators are up to date
-    calculateAccumulators<Color::WHITE>();
-    calculateAccumulators<Color::BLACK>();
-
-    assert(lastCalculatedAccumulator[Color::WHITE] == currentAccumulator && lastCalculatedAccumulator[Color::BLACK] == currentAccumulator);
+template void NNUE::applyRows<FtType::Psq, Color::WHITE>(int16_t(*)[L1_SIZE], int16_t(*)[L1_SIZE], const ThreatInputs::FeatureList&, const ThreatInputs::FeatureList&);
+template void NNUE::applyRows<FtType::Psq, Color::BLACK>(int16_t(*)[L1_SIZE], int16_t(*)[L1_SIZE], const ThreatInputs::FeatureList&, const ThreatInputs::FeatureList&);
+template void NNUE::applyRows<FtType::Threat, Color::WHITE>(int16_t(*)[L1_SIZE], int16_t(*)[L1_SIZE], const ThreatInputs::FeatureList&, const ThreatInputs::FeatureList&);
+template void NNUE::applyRows<FtType::Threat, Color::BLACK>(int16_t(*)[L1_SIZE], int16_t(*)[L1_SIZE], const ThreatInputs::FeatureList&, const ThreatInputs::FeatureList&);
 
+__always_inline int getOutputBucket(Board* board) {
     // Calculate output bucket based on piece count
     int pieceCount = BB::popcount(board->byColor[Color::WHITE] | board->byColor[Color::BLACK]);
     constexpr int divisor = ((32 + OUTPUT_BUCKETS - 1) / OUTPUT_BUCKETS);
     int bucket = (pieceCount - 2) / divisor;
     assert(0 <= bucket && bucket < OUTPUT_BUCKETS);
+    return bucket;
+}
 
-    Accumulator* accumulator = &accumulatorStack[currentAccumulator];
-
-    VecI16* stmThreatAcc = reinterpret_cast<VecI16*>(accumulator->threatState[board->stm]);
-    VecI16* stmPieceAcc = reinterpret_cast<VecI16*>(accumulator->pieceState[board->stm]);
-    VecI16* oppThreatAcc = reinterpret_cast<VecI16*>(accumulator->threatState[1 - board->stm]);
-    VecI16* oppPieceAcc = reinterpret_cast<VecI16*>(accumulator->pieceState[1 - board->stm]);
+__always_inline void activatePairwise(Accumulator* accumulator, Color stm, uint8_t* pairwiseOutputs) {
+    VecI16* stmThreatAcc = reinterpret_cast<VecI16*>(accumulator->threatState[stm]);
+    VecI16* stmPieceAcc = reinterpret_cast<VecI16*>(accumulator->pieceState[stm]);
+    VecI16* oppThreatAcc = reinterpret_cast<VecI16*>(accumulator->threatState[1 - stm]);
+    VecI16* oppPieceAcc = reinterpret_cast<VecI16*>(accumulator->pieceState[1 - stm]);
 
     VecI16 i16Zero = set1Epi16(0);
     VecI16 i16Quant = set1Epi16(INPUT_QUANT);
 
-    // ---------------------- FT ACTIVATION & PAIRWISE ----------------------
-
-    alignas(ALIGNMENT) uint8_t pairwiseOutputs[L1_SIZE];
     VecIu8* pairwiseOutputsVec = reinterpret_cast<VecIu8*>(pairwiseOutputs);
 
     constexpr int inverseShift = 16 - INPUT_SHIFT;
@@ -468,19 +644,11 @@ Eval NNUE::evaluate(Board* board) {
 
         pairwiseOutputsVec[pw / 2 + pairwiseOffset / 2] = packusEpi16(mul1, mul2);
     }
-
-#if defined(PROCESS_NET)
-    nnz.addActivations(pairwiseOutputs);
-#endif
-
-    alignas(ALIGNMENT) int l1MatmulOutputs[L2_SIZE] = {};
-
-    // ---------------------- NNZ COMPUTATION ----------------------
+}
 
 #if defined(__SSSE3__) || defined(__AVX2__) || (defined(__AVX512F__) && defined(__AVX512BW__)) || defined(ARCH_ARM)
+__always_inline int findNNZ(uint8_t* pairwiseOutputs, uint16_t* nnzIndices) {
     int nnzCount = 0;
-    alignas(ALIGNMENT) uint16_t nnzIndices[L1_SIZE / INT8_PER_INT32];
-
     VecI32* pairwiseOutputsVecI32 = reinterpret_cast<VecI32*>(pairwiseOutputs);
 
 #if defined(__AVX512VBMI2__)
@@ -508,7 +676,7 @@ Eval NNUE::evaluate(Board* board) {
 
         for (int j = 0; j < 16 / 8; j++) {
             uint16_t lookup = (nnzMask >> (j * 8)) & 0xFF;
-            VecI16_v128 offsets = loadu_v128(nnzLookup[lookup]);
+            VecI16_v128 offsets = loadu_v128(nnzLookup[lookup].data());
             storeu_v128(nnzIndices + nnzCount, addEpi16_v128(nnzZero, offsets));
             nnzCount += BB::popcount(lookup);
             nnzZero = addEpi16_v128(nnzZero, nnzIncrement);
@@ -516,13 +684,96 @@ Eval NNUE::evaluate(Board* board) {
     }
 #endif
 
+    return nnzCount;
+}
+#endif
+
+// Integer version of everything after the L1 matmul, see HIDDEN_ACTIVATION_SHIFT / HIDDEN_WEIGHT_SHIFT for the scales
+__always_inline Eval propagateIntegerLayers(NetworkData* networkData, int bucket, int* l1MatmulOutputs) {
+    constexpr int one = 1 << HIDDEN_ACTIVATION_SHIFT;
+
+    // ---------------------- ACTIVATE L1 ----------------------
+
+    alignas(ALIGNMENT) int16_t l1Outputs[2 * L2_SIZE];
+    for (int l1 = 0; l1 < L2_SIZE; l1++) {
+        int l1Result = std::clamp(l1MatmulOutputs[l1] + networkData->l1BiasesQuantised[bucket][l1], -L1_OUTPUT_LIMIT, L1_OUTPUT_LIMIT);
+        l1Result = std::clamp((l1Result * L1_ACTIVATION_MULTIPLIER) >> 16, -one, one);
+        l1Outputs[l1] = std::max(l1Result, 0);
+        l1Outputs[l1 + L2_SIZE] = (l1Result * l1Result) >> HIDDEN_ACTIVATION_SHIFT;
+    }
+
+    // ---------------------- L2 PROPAGATION & ACTIVATION ----------------------
+
+    alignas(ALIGNMENT) int l2Outputs[L3_SIZE];
+    memcpy(l2Outputs, networkData->l2BiasesQuantised[bucket], sizeof(l2Outputs));
+
+    VecI32* l2OutputsVec = reinterpret_cast<VecI32*>(l2Outputs);
+    int* l1OutputPairs = reinterpret_cast<int*>(l1Outputs);
+    for (int l1 = 0; l1 < L2_SIZE; l1++) {
+        VecI16 pair = set1PairEpi16(l1OutputPairs[l1]);
+        VecI16* weights = reinterpret_cast<VecI16*>(&networkData->l2WeightsQuantised[bucket][l1 * 2 * L3_SIZE]);
+        for (int l2 = 0; l2 < L3_SIZE / I32_VEC_SIZE; l2++) {
+            l2OutputsVec[l2] = dpwssdEpi32(l2OutputsVec[l2], pair, weights[l2]);
+        }
+    }
+
+    // The clipped outputs are squared at a precision that keeps the product within 32 bits
+    constexpr int squarePrecision = 14;
+    alignas(ALIGNMENT) int16_t l2Activated[L3_SIZE];
+    for (int l2 = 0; l2 < L3_SIZE; l2++) {
+        int clipped = std::clamp(l2Outputs[l2], 0, 1 << HIDDEN_OUTPUT_SHIFT) >> (HIDDEN_OUTPUT_SHIFT - squarePrecision);
+        l2Activated[l2] = (clipped * clipped) >> (2 * squarePrecision - HIDDEN_ACTIVATION_SHIFT);
+    }
+
+    // ---------------------- L3 PROPAGATION ----------------------
+
+    int16_t* l3Weights = networkData->l3WeightsQuantised[bucket];
+    int result = networkData->l3BiasesQuantised[bucket];
+    for (int l2 = 0; l2 < L3_SIZE; l2++)
+        result += l2Activated[l2] * l3Weights[l2];
+    for (int l1 = 0; l1 < 2 * L2_SIZE; l1++)
+        result += l1Outputs[l1] * l3Weights[L3_SIZE + l1];
+
+    return static_cast<int64_t>(result) * NETWORK_SCALE / (1 << HIDDEN_OUTPUT_SHIFT);
+}
+
+template<bool integerLayers>
+Eval NNUE::evaluate(Board* board) {
+    // Make sure the current accumulators are up to date
+    calculateAccumulators<Color::WHITE>();
+    calculateAccumulators<Color::BLACK>();
+
+    assert(lastCalculatedAccumulator[Color::WHITE] == currentAccumulator && lastCalculatedAccumulator[Color::BLACK] == currentAccumulator);
+
+    int bucket = getOutputBucket(board);
+    Accumulator* accumulator = &accumulatorStack[currentAccumulator];
+
+    // ---------------------- FT ACTIVATION & PAIRWISE ----------------------
+
+    alignas(ALIGNMENT) uint8_t pairwiseOutputs[L1_SIZE];
+    activatePairwise(accumulator, board->stm, pairwiseOutputs);
+
+#if defined(PROCESS_NET)
+    nnz.addActivations(pairwiseOutputs);
+#endif
+    if (nnzProfile)
+        nnzProfile->add(bucket, pairwiseOutputs);
+
+    alignas(ALIGNMENT) int l1MatmulOutputs[L2_SIZE] = {};
+
+    // ---------------------- NNZ COMPUTATION ----------------------
+
+#if defined(__SSSE3__) || defined(__AVX2__) || (defined(__AVX512F__) && defined(__AVX512BW__)) || defined(ARCH_ARM)
+    alignas(ALIGNMENT) uint16_t nnzIndices[L1_SIZE / INT8_PER_INT32];
+    int nnzCount = findNNZ(pairwiseOutputs, nnzIndices);
+
     // ---------------------- SPARSE L1 PROPAGATION ----------------------
 
     int* pairwiseOutputsPacks = reinterpret_cast<int*>(pairwiseOutputs);
     VecI32* l1MatmulOutputsVec = reinterpret_cast<VecI32*>(l1MatmulOutputs);
     int8_t* l1Weights = networkData->l1Weights[bucket];
 
-#if defined(__AVX512VBMI2__)
+#if defined(__AVX512VNNI__)
     VecI32 acc0{}, acc1{};
 
     int i = 0;
@@ -582,6 +833,9 @@ Eval NNUE::evaluate(Board* board) {
     }
 #endif
 
+    if constexpr (integerLayers)
+        return propagateIntegerLayers(networkData, bucket, l1MatmulOutputs);
+
     // ---------------------- CONVERT TO FLOATS & ACTIVATE L1 ----------------------
 
     alignas(ALIGNMENT) float l1Outputs[2 * L2_SIZE];
@@ -680,3 +934,156 @@ Eval NNUE::evaluate(Board* board) {
 
     return result * NETWORK_SCALE;
 }
+
+template Eval NNUE::evaluate<false>(Board* board);
+template Eval NNUE::evaluate<true>(Board* board);
+
+static_assert(EVAL_BATCH_SIZE <= MAX_PLY + 8, "Batch has to fit on the accumulator stack");
+
+void NNUE::evaluateBatch(Board** boards, int count, Eval* results) {
+    if (!networkData) {
+        assert(globalNetworkData);
+        networkData = globalNetworkData;
+    }
+
+    for (int base = 0; base < count; base += EVAL_BATCH_SIZE) {
+        int batchSize = std::min(EVAL_BATCH_SIZE, count - base);
+
+#if (defined(__FMA__) || defined(__AVX2__) || (defined(__AVX512F__) && defined(__AVX512BW__)) || defined(ARCH_ARM)) && !defined(INTEGER_LAYERS)
+        // ---------------------- ACCUMULATORS & PAIRWISE ----------------------
+
+        // Every position gets its own slot on the accumulator stack, built from scratch
+        alignas(ALIGNMENT) uint8_t pairwiseOutputs[EVAL_BATCH_SIZE][L1_SIZE];
+        int buckets[EVAL_BATCH_SIZE];
+        for (int b = 0; b < batchSize; b++) {
+            Board* board = boards[base + b];
+            Accumulator* accumulator = &accumulatorStack[b];
+            resetAccumulator<Color::WHITE>(board, accumulator);
+            resetAccumulator<Color::BLACK>(board, accumulator);
+
+            activatePairwise(accumulator, board->stm, pairwiseOutputs[b]);
+            buckets[b] = getOutputBucket(board);
+        }
+
+        VecF psNorm = set1Ps(L1_NORMALISATION);
+        VecF psZero = set1Ps(0.0f);
+        VecF psOne = set1Ps(1.0f);
+
+        // Positions sharing an output bucket are propagated together, so every weight row is loaded once per group
+        for (int bucket = 0; bucket < OUTPUT_BUCKETS; bucket++) {
+            int members[EVAL_BATCH_SIZE];
+            int memberCount = 0;
+            for (int b = 0; b < batchSize; b++) {
+                if (buckets[b] == bucket)
+                    members[memberCount++] = b;
+            }
+            if (!memberCount)
+                continue;
+
+            // ---------------------- SPARSE L1 PROPAGATION ----------------------
+
+            // Union of the non-zero blocks of all members; zero blocks of a single member contribute nothing
+            alignas(ALIGNMENT) uint8_t combinedOutputs[L1_SIZE] = {};
+            for (int m = 0; m < memberCount; m++) {
+                uint64_t* combined = reinterpret_cast<uint64_t*>(combinedOutputs);
+                uint64_t* outputs = reinterpret_cast<uint64_t*>(pairwiseOutputs[members[m]]);
+                for (int i = 0; i < L1_SIZE / 8; i++)
+                    combined[i] |= outputs[i];
+            }
+
+            alignas(ALIGNMENT) uint16_t nnzIndices[L1_SIZE / INT8_PER_INT32];
+            int nnzCount = findNNZ(combinedOutputs, nnzIndices);
+
+            alignas(ALIGNMENT) int l1MatmulOutputs[EVAL_BATCH_SIZE][L2_SIZE] = {};
+
+            int8_t* l1Weights = networkData->l1Weights[bucket];
+            for (int i = 0; i < nnzCount; i++) {
+                int pw = nnzIndices[i];
+                VecI8* weights = reinterpret_cast<VecI8*>(&l1Weights[pw * INT8_PER_INT32 * L2_SIZE]);
+
+                for (int m = 0; m < memberCount; m++) {
+                    VecIu8 u8 = set1Epi32(reinterpret_cast<int*>(pairwiseOutputs[members[m]])[pw]);
+                    VecI32* l1MatmulOutputsVec = reinterpret_cast<VecI32*>(l1MatmulOutputs[m]);
+                    for (int l1 = 0; l1 < L2_SIZE / I32_VEC_SIZE; l1++)
+                        l1MatmulOutputsVec[l1] = dpbusdEpi32(l1MatmulOutputsVec[l1], u8, weights[l1]);
+                }
+            }
+
+            // ---------------------- CONVERT TO FLOATS & ACTIVATE L1 ----------------------
+
+            alignas(ALIGNMENT) float l1Outputs[EVAL_BATCH_SIZE][2 * L2_SIZE];
+            VecF* l1Biases = reinterpret_cast<VecF*>(networkData->l1Biases[bucket]);
+            for (int m = 0; m < memberCount; m++) {
+                VecI32* l1MatmulOutputsVec = reinterpret_cast<VecI32*>(l1MatmulOutputs[m]);
+                VecF* l1OutputsVec = reinterpret_cast<VecF*>(l1Outputs[m]);
+                for (int l2 = 0; l2 < L2_SIZE / FLOAT_VEC_SIZE; l2++) {
+                    VecF converted = cvtepi32Ps(l1MatmulOutputsVec[l2]);
+                    VecF l1Result = fmaddPs(converted, psNorm, l1Biases[l2]);
+                    l1OutputsVec[l2] = maxPs(minPs(l1Result, psOne), psZero);
+                    l1OutputsVec[l2 + L2_SIZE / FLOAT_VEC_SIZE] = minPs(mulPs(l1Result, l1Result), psOne);
+                }
+            }
+
+            // ---------------------- L2 PROPAGATION & ACTIVATION ----------------------
+
+            alignas(ALIGNMENT) float l2Outputs[EVAL_BATCH_SIZE][L3_SIZE];
+            for (int m = 0; m < memberCount; m++)
+                memcpy(l2Outputs[m], networkData->l2Biases[bucket], sizeof(l2Outputs[m]));
+
+            for (int l1 = 0; l1 < 2 * L2_SIZE; l1++) {
+                VecF* weights = reinterpret_cast<VecF*>(&networkData->l2Weights[bucket][l1 * L3_SIZE]);
+                for (int m = 0; m < memberCount; m++) {
+                    VecF l1Vec = set1Ps(l1Outputs[m][l1]);
+                    VecF* l2OutputsVec = reinterpret_cast<VecF*>(l2Outputs[m]);
+                    for (int l2 = 0; l2 < L3_SIZE / FLOAT_VEC_SIZE; l2++) {
+                        l2OutputsVec[l2] = fmaddPs(l1Vec, weights[l2], l2OutputsVec[l2]);
+                    }
+                }
+            }
+
+            // ---------------------- L3 PROPAGATION ----------------------
+
+            constexpr int chunks = 64 / sizeof(VecF);
+            VecF* l3WeightsVec = reinterpret_cast<VecF*>(networkData->l3Weights[bucket]);
+
+            for (int m = 0; m < memberCount; m++) {
+                VecF* l1OutputsVec = reinterpret_cast<VecF*>(l1Outputs[m]);
+                VecF* l2OutputsVec = reinterpret_cast<VecF*>(l2Outputs[m]);
+                for (int l2 = 0; l2 < L3_SIZE / FLOAT_VEC_SIZE; l2++) {
+                    VecF l2Activated = maxPs(minPs(l2OutputsVec[l2], psOne), psZero);
+                    l2OutputsVec[l2] = mulPs(l2Activated, l2Activated);
+                }
+
+                VecF resultSums[chunks];
+                for (int j = 0; j < chunks; j++)
+                    resultSums[j] = psZero;
+
+                for (int l2 = 0; l2 < L3_SIZE / FLOAT_VEC_SIZE; l2 += chunks) {
+                    for (int chunk = 0; chunk < chunks; chunk++) {
+                        resultSums[chunk] = fmaddPs(l2OutputsVec[l2 + chunk], l3WeightsVec[l2 + chunk], resultSums[chunk]);
+                    }
+                }
+                for (int l1 = 0; l1 < 2 * L2_SIZE / FLOAT_VEC_SIZE; l1 += chunks) {
+                    for (int chunk = 0; chunk < chunks; chunk++) {
+                        resultSums[chunk] = fmaddPs(l1OutputsVec[l1 + chunk], l3WeightsVec[L3_SIZE / FLOAT_VEC_SIZE + l1 + chunk], resultSums[chunk]);
+                    }
+                }
+
+                float result = networkData->l3Biases[bucket] + reduceAddPs(resultSums);
+                results[base + members[m]] = result * NETWORK_SCALE;
+            }
+        }
+#else
+        // Without vectorised float layers (or with integer ones) there is nothing to share between positions
+        for (int b = 0; b < batchSize; b++) {
+            reset(boards[base + b]);
+            results[base + b] = evaluate(boards[base + b]);
+        }
+#endif
+    }
+
+    // The accumulator stack no longer describes a search line
+    currentAccumulator = 0;
+    lastCalculatedAccumulator[Color::WHITE] = 0;
+    lastCalculatedAccumulator[Color::BLACK] = 0;
+}
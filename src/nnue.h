@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 
 #include "types.h"
 #include "threat-inputs.h"
@@ -26,6 +27,9 @@ constexpr int L3_SIZE = 32;
 
 constexpr int OUTPUT_BUCKETS = 8;
 
+constexpr int EVAL_BATCH_SIZE = 16;
+constexpr int MAX_FUSED_PLIES = 4;
+
 constexpr int NETWORK_SCALE = 287;
 constexpr int INPUT_QUANT = 255;
 constexpr int L1_QUANT = 64;
@@ -33,6 +37,21 @@ constexpr int INPUT_SHIFT = 9;
 
 constexpr float L1_NORMALISATION = static_cast<float>(1 << INPUT_SHIFT) / static_cast<float>(INPUT_QUANT * INPUT_QUANT * L1_QUANT);
 
+// Integer L2 / L3: activations are scaled by 1 << HIDDEN_ACTIVATION_SHIFT, weights by 1 << HIDDEN_WEIGHT_SHIFT
+constexpr int HIDDEN_ACTIVATION_SHIFT = 9;
+constexpr int HIDDEN_WEIGHT_SHIFT = 10;
+constexpr int HIDDEN_OUTPUT_SHIFT = HIDDEN_ACTIVATION_SHIFT + HIDDEN_WEIGHT_SHIFT;
+// L1 matmul outputs are clamped to this before being rescaled, which keeps the product below in range
+constexpr int L1_OUTPUT_LIMIT = 1 << 13;
+// Multiplier mapping L1 matmul outputs to the hidden activation scale, with 16 fractional bits
+constexpr int L1_ACTIVATION_MULTIPLIER = static_cast<int>(L1_NORMALISATION * (1 << (HIDDEN_ACTIVATION_SHIFT + 16)) + 0.5f);
+
+#if defined(INTEGER_LAYERS)
+constexpr bool USE_INTEGER_LAYERS = true;
+#else
+constexpr bool USE_INTEGER_LAYERS = false;
+#endif
+
 constexpr int ALIGNMENT = 64;
 
 constexpr int I16_VEC_SIZE = sizeof(VecI16) / sizeof(int16_t);
@@ -43,6 +62,15 @@ constexpr int INT8_PER_INT32 = sizeof(int32_t) / sizeof(int8_t);
 
 constexpr int L1_ITERATIONS = L1_SIZE / I16_VEC_SIZE;
 
+// Number of vectors of an accumulator that are kept in registers while applying weight rows
+// (half of the architectural vector registers, leaving the rest for weights)
+#if (defined(__AVX512F__) && defined(__AVX512BW__)) || defined(ARCH_ARM)
+constexpr int ACCUMULATOR_TILE = 16;
+#else
+constexpr int ACCUMULATOR_TILE = 8;
+#endif
+static_assert(L1_ITERATIONS % ACCUMULATOR_TILE == 0);
+
 enum class FtType {
   Psq,
   Threat,
@@ -91,9 +119,13 @@ struct Accumulator {
   int numThreatsRemoved;
 
   KingBucketInfo kingBucketInfo[2];
+  // Board of this ply, the lazy updates only read its piece placement (the first two cache lines)
   Board* board;
 };
 
+// Piece features added or removed by a single move
+using PieceDeltaList = ArrayVec<int, 2>;
+
 struct FinnyEntry {
   alignas(ALIGNMENT) int16_t pieceState[2][L1_SIZE];
 
@@ -101,6 +133,58 @@ struct FinnyEntry {
   Bitboard byPiece[2][Piece::TOTAL];
 };
 
+// Threat features are only rebuilt when the king crosses the e-file, so one entry per mirroring is kept
+struct ThreatFinnyEntry {
+  alignas(ALIGNMENT) int16_t threatState[2][L1_SIZE];
+
+  ThreatInputs::FeatureList features[2];
+};
+
+struct ThreatRefreshStats {
+  uint64_t refreshes;
+  uint64_t rowsApplied;
+  uint64_t rowsFromScratch;
+
+  void clear() {
+    refreshes = 0;
+    rowsApplied = 0;
+    rowsFromScratch = 0;
+  }
+};
+
+struct FusedUpdateStats {
+  uint64_t updates;
+  uint64_t plies;
+  uint64_t rowsApplied;
+  uint64_t rowsCancelled;
+
+  void clear() {
+    updates = 0;
+    plies = 0;
+    rowsApplied = 0;
+    rowsCancelled = 0;
+  }
+};
+
+// Per output bucket activation counts of the pairwise outputs, used to find a neuron order with fewer non-zero L1 input chunks
+struct NNZProfile {
+  uint64_t evaluations[OUTPUT_BUCKETS];
+  uint64_t nonZeroChunks[OUTPUT_BUCKETS];
+  uint64_t activations[OUTPUT_BUCKETS][L1_SIZE];
+
+  void clear() {
+    memset(this, 0, sizeof(NNZProfile));
+  }
+
+  void add(int bucket, uint8_t* pairwiseOutputs);
+  void merge(const NNZProfile& other);
+
+  // Orders the L1_SIZE / 2 neuron pairs by how often they are active, summed over all buckets
+  void computeOrder(int* order);
+  // Non-zero chunks per evaluation of the given bucket if the neurons were ordered like this, assuming independent activations
+  double expectedNonZeroChunks(int bucket, const int* order);
+};
+
 struct NetworkData {
   alignas(ALIGNMENT) int16_t inputPsqWeights[768 * KING_BUCKETS * L1_SIZE];
   alignas(ALIGNMENT) int8_t inputThreatWeights[(ThreatInputs::PAWN_PAIR_FEATURE_COUNT + ThreatInputs::FEATURE_COUNT) * L1_SIZE];
@@ -111,11 +195,21 @@ struct NetworkData {
   alignas(ALIGNMENT) float   l2Biases[OUTPUT_BUCKETS][L3_SIZE];
   alignas(ALIGNMENT) float   l3Weights[OUTPUT_BUCKETS][L3_SIZE + 2 * L2_SIZE];
   alignas(ALIGNMENT) float   l3Biases[OUTPUT_BUCKETS];
+
+  // Integer copies of the layers after L1, derived while processing the net.
+  // L2 weights are stored as [input / 2][output][input % 2] for the pairwise dot products
+  alignas(ALIGNMENT) int32_t l1BiasesQuantised[OUTPUT_BUCKETS][L2_SIZE];
+  alignas(ALIGNMENT) int16_t l2WeightsQuantised[OUTPUT_BUCKETS][2 * L2_SIZE * L3_SIZE];
+  alignas(ALIGNMENT) int32_t l2BiasesQuantised[OUTPUT_BUCKETS][L3_SIZE];
+  alignas(ALIGNMENT) int16_t l3WeightsQuantised[OUTPUT_BUCKETS][L3_SIZE + 2 * L2_SIZE];
+  alignas(ALIGNMENT) int32_t l3BiasesQuantised[OUTPUT_BUCKETS];
 };
 
 extern NetworkData* globalNetworkData;
 
 void initNetworkData();
+// Writes the network with its neuron pairs reordered, so that neuron i of the output network is neuron order[i] of the input network
+void permuteNetworkNeurons(NetworkData* output, const NetworkData* input, const int* order);
 
 struct Board;
 
@@ -123,10 +217,15 @@ class NNUE {
 public:
 
   NetworkData* networkData;
+  ThreatRefreshStats threatRefreshStats;
+  FusedUpdateStats fusedUpdateStats;
+  NNZProfile* nnzProfile = nullptr;
 
   NNUE() = default;
   NNUE(NetworkData* _networkData) {
     networkData = _networkData;
+    threatRefreshStats.clear();
+    fusedUpdateStats.clear();
   }
 
   Accumulator accumulatorStack[MAX_PLY + 8];
@@ -134,10 +233,11 @@ public:
   int lastCalculatedAccumulator[2];
 
   FinnyEntry finnyTable[2][KING_BUCKETS];
+  ThreatFinnyEntry threatFinnyTable[2];
 
   void updateThreat(Piece piece, Piece attackedPiece, Square square, Square attackedSquare, Color pieceColor, Color attackedColor, bool add);
 
-#if defined(__AVX512VBMI2__)
+#if defined(__AVX512VBMI2__) || defined(__AVX2__)
   template<bool add, bool computeRays>
   void updatePieceThreatsGeometry(Board* board, Piece piece, Color pieceColor, Square square, Square ignore);
 #endif
@@ -150,30 +250,37 @@ public:
   template<Color side>
   void resetAccumulator(Board* board, Accumulator* acc);
 
+  // The integer path replaces the float L2 / L3 propagation, it is the default in INTEGER_LAYERS builds
+  template<bool integerLayers = USE_INTEGER_LAYERS>
   Eval evaluate(Board* board);
+  // Evaluates independent positions, building their accumulators from scratch on the accumulator stack.
+  // reset() has to be called before this NNUE is used for incremental evaluation again
+  void evaluateBatch(Board** boards, int count, Eval* results);
   template<Color side>
   void calculateAccumulators();
+  template<Color side>
+  bool canFuseUpdates();
+  template<Color side>
+  void fusedUpdateAccumulators();
 
   template<Color side>
   void refreshPieceFeatures(Accumulator* acc, KingBucketInfo* kingBucket);
   template<Color side>
-  void refreshThreatFeatures(Accumulator* acc);
+  void refreshThreatFeatures(Accumulator* acc, KingBucketInfo* kingBucket);
+
+  template<Color side>
+  void addPieceDeltas(DirtyPiece& dirtyPiece, KingBucketInfo* kingBucket, PieceDeltaList& adds, PieceDeltaList& subs);
+  template<Color side, typename List>
+  void addDirtyThreatDeltas(Accumulator* acc, KingBucketInfo* kingBucket, List& adds, List& subs);
 
   template<Color side>
   void incrementallyUpdatePieceFeatures(Accumulator* inputAcc, Accumulator* outputAcc, KingBucketInfo* kingBucket);
   template<Color side>
   void incrementallyUpdateThreatFeatures(Accumulator* inputAcc, Accumulator* outputAcc, KingBucketInfo* kingBucket);
 
-  template<FtType type, Color side>
-  void addToAccumulator(int16_t(*inputData)[L1_SIZE], int16_t(*outputData)[L1_SIZE], int featureIndex);
-  template<FtType type, Color side>
-  void subFromAccumulator(int16_t(*inputData)[L1_SIZE], int16_t(*outputData)[L1_SIZE], int featureIndex);
-  template<FtType type, Color side>
-  void addSubToAccumulator(int16_t(*inputData)[L1_SIZE], int16_t(*outputData)[L1_SIZE], int addIndex, int subIndex);
-
-  template<Color side>
-  void applyThreatRows(int16_t(*inputData)[L1_SIZE], int16_t(*outputData)[L1_SIZE],
-                       const ThreatInputs::FeatureList& adds, const ThreatInputs::FeatureList& subs);
+  // Applies all add and sub rows to one ACCUMULATOR_TILE of the accumulator at a time
+  template<FtType type, Color side, typename List>
+  void applyRows(int16_t(*inputData)[L1_SIZE], int16_t(*outputData)[L1_SIZE], const List& adds, const List& subs);
 
 };
 
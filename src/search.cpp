@@ -1,4 +1,5 @@
 #include <cstdint>
+#include <cstring>
 #include <algorithm>
 #include <inttypes.h>
 #include <cassert>
@@ -6,6 +7,7 @@
 #include <cmath>
 #include <thread>
 #include <map>
+#include <sstream>
 #include <new>
 
 #include <chrono>
@@ -207,55 +209,78 @@ void initReductions() {
     }
 }
 
-uint64_t perftInternal(Board& board, Depth depth) {
-    if (depth == 0) return 1;
+uint64_t perftInternal(Board& board, NNUE* nnue, Depth depth) {
+    uint64_t nodes = 0;
+    if (depth > 1 && PERFT_TT.probe(board.hashes.hash, depth, &nodes))
+        return nodes;
 
     MoveList moves;
-    generateMoves(&board, moves);
+    generateLegalMoves(&board, moves);
 
-    uint64_t nodes = 0;
-    for (auto& move : moves) {
-        if (!board.isLegal(move))
-            continue;
+    // Bulk counting: the legal moves at the last ply are the leaf nodes
+    if (depth == 1) return moves.size();
 
+    for (auto& move : moves) {
         Board boardCopy = board;
-        boardCopy.doMove(move, boardCopy.hashAfter(move).first, &UCI::nnue);
-        uint64_t subNodes = perftInternal(boardCopy, depth - 1);
-        UCI::nnue.decrementAccumulator();
-
-        nodes += subNodes;
+        boardCopy.doMove(move, boardCopy.hashAfter(move).first, nnue);
+        nodes += perftInternal(boardCopy, nnue, depth - 1);
+        nnue->decrementAccumulator();
     }
+
+    PERFT_TT.store(board.hashes.hash, depth, nodes);
     return nodes;
 }
 
-uint64_t perft(Board& board, Depth depth) {
-    clock_t begin = clock();
-    UCI::nnue.reset(&board);
+void Worker::tperft() {
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    nnue.reset(&rootBoard);
+    searchData.nodesSearched.store(0, std::memory_order_relaxed);
 
+    Depth depth = searchParameters.depth;
     MoveList moves;
-    generateMoves(&board, moves);
+    generateLegalMoves(&rootBoard, moves);
 
-    uint64_t nodes = 0;
-    for (auto& move : moves) {
-        if (!board.isLegal(move))
-            continue;
+    // Root moves are handed out one at a time, so all workers stay busy until the last subtrees
+    rootMoveNodes.clear();
+    int index;
+    while ((index = threadPool->perftRootIndex.fetch_add(1, std::memory_order_relaxed)) < moves.size()) {
+        Move move = moves[index];
+        Board boardCopy = rootBoard;
+        boardCopy.doMove(move, boardCopy.hashAfter(move).first, &nnue);
+        uint64_t subNodes = depth > 1 ? perftInternal(boardCopy, &nnue, depth - 1) : 1;
+        nnue.decrementAccumulator();
+
+        rootMoveNodes[move] = subNodes;
+        searchData.nodesSearched.fetch_add(subNodes, std::memory_order_relaxed);
+    }
 
-        Board boardCopy = board;
-        boardCopy.doMove(move, boardCopy.hashAfter(move).first, &UCI::nnue);
-        uint64_t subNodes = perftInternal(boardCopy, depth - 1);
-        UCI::nnue.decrementAccumulator();
+    if (!mainThread)
+        return;
 
-        std::cout << move.toString(UCI::Options.chess960.value) << ": " << subNodes << std::endl;
+    threadPool->waitForHelpersFinished();
+    double time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count() / 1e6;
 
+    uint64_t nodes = 0;
+    for (Move move : moves) {
+        uint64_t subNodes = 0;
+        for (auto& worker : threadPool->workers) {
+            auto it = worker->rootMoveNodes.find(move);
+            if (it != worker->rootMoveNodes.end())
+                subNodes = it->second;
+        }
+        std::cout << move.toString(UCI::Options.chess960.value) << ": " << subNodes << std::endl;
         nodes += subNodes;
     }
 
-    clock_t end = clock();
-    double time = (double)(end - begin) / CLOCKS_PER_SEC;
     uint64_t nps = nodes / time;
     std::cout << "Perft: " << nodes << " nodes in " << time << "s => " << nps << "nps" << std::endl;
+    for (auto& worker : threadPool->workers) {
+        uint64_t workerNodes = worker->searchData.nodesSearched.load(std::memory_order_relaxed);
+        std::cout << "Thread " << worker->threadId << ": " << workerNodes << " nodes => " << workerNodes / time / 1e6 << " Mnps" << std::endl;
+    }
 
-    return nodes;
+    // All workers are done with the perft table, so its memory goes back until the next perft
+    PERFT_TT.release();
 }
 
 void updatePv(SearchStack* stack, Move move) {
@@ -307,7 +332,8 @@ int drawEval(Worker* thread) {
 
 Board* Worker::doMove(Board* board, Hash newHash, Move move) {
     Board* boardCopy = board + 1;
-    *boardCopy = *board;
+    std::memcpy(boardCopy, board, BOARD_STATE_SIZE);
+    searchData.boardCopies++;
 
     boardCopy->doMove(move, newHash, &nnue);
     boardHistory.push_back(newHash);
@@ -320,8 +346,11 @@ void Worker::undoMove() {
 }
 
 Board* Worker::doNullMove(Board* board) {
+    assert(!board->checkers);
+
     Board* boardCopy = board + 1;
-    *boardCopy = *board;
+    std::memcpy(boardCopy, board, BOARD_STATE_SIZE);
+    searchData.boardCopies++;
 
     boardCopy->doNullMove();
     boardHistory.push_back(boardCopy->hashes.hash);
@@ -412,15 +441,8 @@ bool Worker::isDraw(Board* board, int ply) {
 
         // If in check, it might be checkmate
         MoveList moves;
-        generateMoves(board, moves);
-        int legalMoveCount = 0;
-        for (auto& move : moves) {
-            if (!board->isLegal(move))
-                continue;
-            legalMoveCount++;
-        }
-
-        return legalMoveCount > 0;
+        generateEvasions(board, moves);
+        return moves.size() > 0;
     }
 
     // Otherwise, no draw
@@ -440,7 +462,11 @@ Eval Worker::qsearch(Board* board, SearchStack* stack, Eval alpha, Eval beta) {
 
     assert(alpha >= -EVAL_INFINITE && alpha < beta && beta <= EVAL_INFINITE);
 
-    if (mainThread && timeOver(searchParameters, searchData))
+    if (independentSearch) {
+        if (timeOver(searchParameters, searchData))
+            stopped.store(true, std::memory_order_relaxed);
+    }
+    else if (mainThread && timeOver(searchParameters, searchData))
         threadPool->stopSearching();
 
     // Check for stop
@@ -459,7 +485,7 @@ Eval Worker::qsearch(Board* board, SearchStack* stack, Eval alpha, Eval beta) {
     bool ttPv = pvNode;
 
     Hash fmrHash = board->hashes.hash ^ Zobrist::FMR[board->rule50_ply / Zobrist::FMR_GRANULARITY];
-    ttEntry = TT.probe(fmrHash, &ttHit);
+    ttEntry = tt->probe(fmrHash, &ttHit);
     if (ttHit) {
         ttMove = ttEntry->getMove();
         ttValue = valueFromTt(ttEntry->getValue(), stack->ply, board->rule50_ply);
@@ -546,7 +572,7 @@ movesLoopQsearch:
             continue;
 
         auto [newHash, newFmrHash] = board->hashAfter(move);
-        TT.prefetch(newFmrHash);
+        tt->prefetch(newFmrHash);
         moveCount++;
         searchData.nodesSearched.fetch_add(1, std::memory_order_relaxed);
 
@@ -628,7 +654,11 @@ Eval Worker::search(Board* board, SearchStack* stack, Depth depth, Eval alpha, E
     if (!rootNode) {
 
         // Check for time / node limits on main thread
-        if (mainThread && timeOver(searchParameters, searchData))
+        if (independentSearch) {
+            if (timeOver(searchParameters, searchData))
+                stopped.store(true, std::memory_order_relaxed);
+        }
+        else if (mainThread && timeOver(searchParameters, searchData))
             threadPool->stopSearching();
 
         // Check for stop or max depth
@@ -663,10 +693,22 @@ Eval Worker::search(Board* board, SearchStack* stack, Depth depth, Eval alpha, E
     uint8_t ttFlag = TT_NOBOUND;
     stack->ttPv = excluded ? stack->ttPv : pvNode;
 
+    // At the root, the best move that is not excluded by MultiPV or searchmoves is tried first
+    RootMove* pvRootMove = nullptr;
+    if (rootNode) {
+        pvRootMove = &rootMoves[0];
+        for (RootMove& rm : rootMoves) {
+            if (std::find(excludedRootMoves.begin(), excludedRootMoves.end(), rm.move) == excludedRootMoves.end()) {
+                pvRootMove = &rm;
+                break;
+            }
+        }
+    }
+
     if (!excluded) {
-        ttEntry = TT.probe(fmrHash, &ttHit);
+        ttEntry = tt->probe(fmrHash, &ttHit);
         if (ttHit) {
-            ttMove = rootNode && rootMoves[0].value > -EVAL_INFINITE ? rootMoves[0].move : ttEntry->getMove();
+            ttMove = rootNode && pvRootMove->value > -EVAL_INFINITE ? pvRootMove->move : ttEntry->getMove();
             ttValue = valueFromTt(ttEntry->getValue(), stack->ply, board->rule50_ply);
             ttEval = ttEntry->getEval();
             ttDepth = ttEntry->getDepth();
@@ -876,7 +918,7 @@ Eval Worker::search(Board* board, SearchStack* stack, Depth depth, Eval alpha, E
                 continue;
 
             auto [newHash, newFmrHash] = board->hashAfter(move);
-            TT.prefetch(newFmrHash);
+            tt->prefetch(newFmrHash);
 
             Square origin = move.origin();
             Square target = move.target();
@@ -1065,7 +1107,7 @@ Eval Worker::search(Board* board, SearchStack* stack, Depth depth, Eval alpha, E
         }
 
         auto [newHash, newFmrHash] = board->hashAfter(move);
-        TT.prefetch(newFmrHash);
+        tt->prefetch(newFmrHash);
 
         // Some setup stuff
         Square origin = move.origin();
@@ -1310,7 +1352,8 @@ void Worker::tsearch() {
     nnue.reset(&rootBoard);
 
     Move bestTbMove = Move::none();
-    if (mainThread && BB::popcount(rootBoard.byColor[Color::WHITE] | rootBoard.byColor[Color::BLACK]) <= std::min(int(TB_LARGEST), UCI::Options.syzygyProbeLimit.value)) {
+    // The tablebase move could be outside of searchmoves
+    if (mainThread && searchParameters.searchmoves.empty() && BB::popcount(rootBoard.byColor[Color::WHITE] | rootBoard.byColor[Color::BLACK]) <= std::min(int(TB_LARGEST), UCI::Options.syzygyProbeLimit.value)) {
         unsigned result = tb_probe_root(
             rootBoard.byColor[Color::WHITE],
             rootBoard.byColor[Color::BLACK],
@@ -1333,6 +1376,7 @@ void Worker::tsearch() {
 
     searchData.nodesSearched.store(0, std::memory_order_relaxed);
     searchData.tbHits = 0;
+    searchData.boardCopies = 0;
     if (mainThread)
         initTimeManagement(rootBoard, searchParameters, searchData);
 
@@ -1359,6 +1403,156 @@ void Worker::tsearch() {
     }
 }
 
+// Depth-limited alpha-beta that only proves mates: the attacker is restricted to checking moves, the defender tries every evasion
+Eval Worker::mateSearch(Board* board, SearchStack* stack, int depth, Eval alpha, Eval beta) {
+    stack->pvLength = stack->ply;
+    searchData.nodesSearched.fetch_add(1, std::memory_order_relaxed);
+    searchData.selDepth = std::max(stack->ply, searchData.selDepth);
+
+    if (mainThread && timeOver(searchParameters, searchData))
+        threadPool->stopSearching();
+
+    if (stopped.load(std::memory_order_relaxed) || exiting || stack->ply >= MAX_PLY - 1 || (stack->ply > 0 && isDraw(board, stack->ply)))
+        return 0;
+
+    MoveList moves;
+    generateLegalMoves(board, moves);
+    if (moves.size() == 0)
+        return board->checkers ? matedIn(stack->ply) : 0;
+    if (depth <= 0)
+        return 0;
+
+    // Mate distance pruning
+    alpha = std::max(alpha, matedIn(stack->ply));
+    beta = std::min(beta, mateIn(stack->ply + 1));
+    if (alpha >= beta)
+        return alpha;
+
+    // Only proven mates are stored, so every mate bound from the TT can be trusted regardless of its depth
+    bool ttHit = false;
+    Hash fmrHash = board->hashes.hash ^ Zobrist::FMR[board->rule50_ply / Zobrist::FMR_GRANULARITY];
+    TTEntry* ttEntry = tt->probe(fmrHash, &ttHit);
+    Move ttMove = Move::none();
+    if (ttHit) {
+        ttMove = ttEntry->getMove();
+        Eval ttValue = valueFromTt(ttEntry->getValue(), stack->ply, board->rule50_ply);
+        uint8_t ttFlag = ttEntry->getFlag();
+        if (stack->ply > 0 && ttValue != EVAL_NONE && std::abs(ttValue) >= EVAL_MATE_IN_MAX_PLY && (
+            (ttFlag == TT_LOWERBOUND && ttValue >= beta) ||
+            (ttFlag == TT_UPPERBOUND && ttValue <= alpha)
+            ))
+            return ttValue;
+    }
+
+    for (int i = 1; i < moves.size(); i++) {
+        if (moves[i] == ttMove) {
+            std::swap(moves[0], moves[i]);
+            break;
+        }
+    }
+
+    bool attacker = stack->ply % 2 == 0;
+    Eval oldAlpha = alpha;
+    Eval bestValue = -EVAL_INFINITE;
+    Move bestMove = Move::none();
+
+    for (Move move : moves) {
+        if (attacker && !board->givesCheck(move))
+            continue;
+
+        Board* boardCopy = board + 1;
+        std::memcpy(boardCopy, board, BOARD_STATE_SIZE);
+        Hash newHash = board->hashAfter(move).first;
+        boardCopy->doMove<false>(move, newHash, nullptr);
+        boardHistory.push_back(newHash);
+
+        Eval value = -mateSearch(boardCopy, stack + 1, depth - 1, -beta, -alpha);
+
+        boardHistory.pop_back();
+
+        if (stopped.load(std::memory_order_relaxed) || exiting)
+            return 0;
+
+        if (value > bestValue) {
+            bestValue = value;
+            if (value > alpha) {
+                alpha = value;
+                bestMove = move;
+                updatePv(stack, move);
+                if (value >= beta)
+                    break;
+            }
+        }
+    }
+
+    // Without a checking move, no mate can be proven from here
+    if (bestValue == -EVAL_INFINITE)
+        bestValue = 0;
+
+    // A found mate is at least as fast with all moves allowed, and mated in all lines stays an upper bound for the defender
+    if (bestValue >= EVAL_MATE_IN_MAX_PLY && bestValue > oldAlpha)
+        ttEntry->update(fmrHash, bestMove, depth, EVAL_NONE, valueToTT(bestValue, stack->ply), board->rule50_ply, false, TT_LOWERBOUND);
+    else if (bestValue <= -EVAL_MATE_IN_MAX_PLY && bestValue < beta)
+        ttEntry->update(fmrHash, bestMove, depth, EVAL_NONE, valueToTT(bestValue, stack->ply), board->rule50_ply, false, TT_UPPERBOUND);
+
+    return bestValue;
+}
+
+void Worker::tmatesearch() {
+    // Helpers still clear their counters, as nodesSearched() sums over all workers
+    searchData.nodesSearched.store(0, std::memory_order_relaxed);
+    searchData.tbHits = 0;
+
+    // The mate search runs on the main thread only
+    if (!mainThread)
+        return;
+
+    searchData.selDepth = 0;
+    initTimeManagement(rootBoard, searchParameters, searchData);
+
+    std::vector<Board> boardList(MAX_PLY + 2, rootBoard);
+    std::vector<SearchStack> stackList(MAX_PLY + 2);
+    for (int i = 0; i < MAX_PLY + 2; i++)
+        stackList[i].ply = i;
+
+    // Iterate over the number of moves, so that the shortest mate is found first
+    RootMove result = {};
+    for (int mateMoves = 1; mateMoves <= searchParameters.mate && 2 * mateMoves - 1 < MAX_PLY - 1; mateMoves++) {
+        int depth = 2 * mateMoves - 1;
+        Eval value = mateSearch(&boardList[0], &stackList[0], depth, -EVAL_INFINITE, EVAL_INFINITE);
+        if (stopped.load(std::memory_order_relaxed) || exiting)
+            break;
+
+        result.value = value;
+        result.depth = depth;
+        result.selDepth = searchData.selDepth;
+        result.pv.assign(stackList[0].pv, stackList[0].pv + stackList[0].pvLength);
+        result.move = result.pv.empty() ? Move::none() : result.pv[0];
+        rootMoves = { result };
+        if (!UCI::Options.minimal.value)
+            printUCI(this);
+
+        if (value >= EVAL_MATE_IN_MAX_PLY)
+            break;
+    }
+
+    threadPool->stopSearching();
+    threadPool->waitForHelpersFinished();
+
+    if (UCI::Options.minimal.value && !rootMoves.empty())
+        printUCI(this);
+
+    // Without a proven mate, any legal move is returned
+    Move bestMove = result.move;
+    if (!bestMove) {
+        MoveList moves;
+        generateLegalMoves(&rootBoard, moves);
+        if (moves.size() > 0)
+            bestMove = moves[0];
+    }
+    std::cout << "bestmove " << bestMove.toString(UCI::Options.chess960.value) << std::endl;
+}
+
 void Worker::iterativeDeepening() {
     for (auto& a : history.quietHistory)
         for (auto& b : a)
@@ -1367,18 +1561,26 @@ void Worker::iterativeDeepening() {
                     for (auto& e : d)
                         e = 3 * e / 4;
 
+    // With searchmoves, the other legal moves stay out of rootMoves and are excluded from every root search
+    std::vector<Move>& searchmoves = searchParameters.searchmoves;
+    std::vector<Move> unsearchedRootMoves;
     int multiPvCount = 0;
     {
         MoveList moves;
-        generateMoves(&rootBoard, moves);
+        generateLegalMoves(&rootBoard, moves);
+        bool restricted = std::any_of(moves.begin(), moves.end(), [&](Move move) {
+            return std::find(searchmoves.begin(), searchmoves.end(), move) != searchmoves.end();
+        });
         for (auto& move : moves) {
-            if (rootBoard.isLegal(move)) {
-                multiPvCount++;
-
-                RootMove rootMove = {};
-                rootMove.move = move;
-                rootMoves.push_back(rootMove);
+            if (restricted && std::find(searchmoves.begin(), searchmoves.end(), move) == searchmoves.end()) {
+                unsearchedRootMoves.push_back(move);
+                continue;
             }
+            multiPvCount++;
+
+            RootMove rootMove = {};
+            rootMove.move = move;
+            rootMoves.push_back(rootMove);
         }
     }
     multiPvCount = std::min(multiPvCount, UCI::Options.multiPV.value);
@@ -1396,9 +1598,8 @@ void Worker::iterativeDeepening() {
     stackList.resize(MAX_PLY + STACK_OVERHEAD + 2);
     SearchStack* stack = &stackList[STACK_OVERHEAD];
 
-    std::vector<Board> boardList;
-    boardList.resize(MAX_PLY + 2);
-    boardList[0] = rootBoard;
+    // The game constants behind the per-ply state are never copied by doMove, so every ply starts from the root board
+    std::vector<Board> boardList(MAX_PLY + 2, rootBoard);
     Board* board = &boardList[0];
 
     movepickers.resize(MAX_PLY + 2);
@@ -1407,25 +1608,38 @@ void Worker::iterativeDeepening() {
 
     optimism[0] = optimism[1] = 0;
 
+    // Every MultiPV line gets its aspiration window around its own score from the previous iteration
+    std::vector<Eval> previousLineValues(multiPvCount, EVAL_NONE);
+    std::vector<Eval> previousLineMeanScores(multiPvCount, EVAL_NONE);
+
     for (Depth depth = 1; depth <= maxDepth; depth++) {
-        excludedRootMoves.clear();
+        excludedRootMoves = unsearchedRootMoves;
+
+        // A completed root search leaves the stack as it found it, so the later lines continue with the state of the first
+        for (size_t i = 0; i < stackList.capacity(); i++) {
+            stackList[i].pvLength = 0;
+            stackList[i].ply = int(i) - STACK_OVERHEAD;
+            stackList[i].staticEval = EVAL_NONE;
+            stackList[i].excludedMove = Move::none();
+            stackList[i].killer = Move::none();
+            stackList[i].movedPiece = Piece::NONE;
+            stackList[i].move = Move::none();
+            stackList[i].capture = false;
+            stackList[i].inCheck = false;
+            stackList[i].correctionValue = 0;
+            stackList[i].reduction = 0;
+            stackList[i].inLMR = false;
+            stackList[i].ttPv = false;
+        }
+
         for (int rootMoveIdx = 0; rootMoveIdx < multiPvCount; rootMoveIdx++) {
+            previousLineValues[rootMoveIdx] = rootMoves[rootMoveIdx].value;
+            previousLineMeanScores[rootMoveIdx] = rootMoves[rootMoveIdx].meanScore;
+        }
 
-            for (size_t i = 0; i < stackList.capacity(); i++) {
-                stackList[i].pvLength = 0;
-                stackList[i].ply = int(i) - STACK_OVERHEAD;
-                stackList[i].staticEval = EVAL_NONE;
-                stackList[i].excludedMove = Move::none();
-                stackList[i].killer = Move::none();
-                stackList[i].movedPiece = Piece::NONE;
-                stackList[i].move = Move::none();
-                stackList[i].capture = false;
-                stackList[i].inCheck = false;
-                stackList[i].correctionValue = 0;
-                stackList[i].reduction = 0;
-                stackList[i].inLMR = false;
-                stackList[i].ttPv = false;
-            }
+        // Every line is searched again even if its move did not change, as its score is only valid for the depth it was searched to.
+        // A failed aspiration window only repeats the line that failed.
+        for (int rootMoveIdx = 0; rootMoveIdx < multiPvCount; rootMoveIdx++) {
 
             searchData.rootDepth = depth;
             searchData.selDepth = 0;
@@ -1442,16 +1656,18 @@ void Worker::iterativeDeepening() {
                 optimism[flip(board->stm)] = -updatedOptimism;
             }
 
-            if (depth >= aspirationWindowMinDepth) {
+            Eval lineValue = previousLineValues[rootMoveIdx];
+            Eval lineMeanScore = previousLineMeanScores[rootMoveIdx];
+            if (depth >= aspirationWindowMinDepth && lineValue != -EVAL_INFINITE) {
                 // Set up interval for the start of this aspiration window
-                if (rootMoves[0].meanScore == EVAL_NONE)
+                if (lineMeanScore == EVAL_NONE)
                     delta = aspirationWindowDelta;
                 else
-                    delta = std::min<int>(aspirationWindowDeltaBase + rootMoves[0].meanScore * rootMoves[0].meanScore / aspirationWindowDeltaDivisor, EVAL_INFINITE);
+                    delta = std::min<int>(aspirationWindowDeltaBase + lineMeanScore * lineMeanScore / aspirationWindowDeltaDivisor, EVAL_INFINITE);
                 assert(delta > 0);
 
-                alpha = std::max<int>(previousValue - delta, -EVAL_INFINITE);
-                beta = std::min<int>(previousValue + delta, EVAL_INFINITE);
+                alpha = std::max<int>(lineValue - delta, -EVAL_INFINITE);
+                beta = std::min<int>(lineValue + delta, EVAL_INFINITE);
             }
 
             int failHighs = 0;
@@ -1522,7 +1738,10 @@ void Worker::iterativeDeepening() {
                 tmAdjustment *= std::max(0.77 + std::clamp(complexity, 0.0, 200.0) / 386.0, 1.0);
             }
 
-            if (searchData.doSoftTM && timeOverDepthCleared(searchParameters, searchData, tmAdjustment)) {
+            // A search restricted to a single move has nothing left to decide
+            bool singleSearchMove = !unsearchedRootMoves.empty() && rootMoves.size() == 1 && searchData.maxTime;
+
+            if (searchData.doSoftTM && (singleSearchMove || timeOverDepthCleared(searchParameters, searchData, tmAdjustment))) {
                 threadPool->stopSearching();
                 return;
             }
@@ -1614,20 +1833,27 @@ Worker* Worker::chooseBestThread() {
 }
 
 void Worker::tdatagen() {
+    fixedSearch();
+    printUCI(this);
+
+    std::cout << "bestmove " << rootMoves[0].move.toString(UCI::Options.chess960.value) << std::endl;
+}
+
+// Searches the root board on this worker alone, up to the depth and node limits and without time management or output
+void Worker::fixedSearch() {
     nnue.reset(&rootBoard);
 
     searchData.nodesSearched.store(0, std::memory_order_relaxed);
     searchData.tbHits = 0;
+    searchData.boardCopies = 0;
     initTimeManagement(rootBoard, searchParameters, searchData);
     {
         MoveList moves;
-        generateMoves(&rootBoard, moves);
+        generateLegalMoves(&rootBoard, moves);
         for (auto& move : moves) {
-            if (rootBoard.isLegal(move)) {
-                RootMove rootMove = {};
-                rootMove.move = move;
-                rootMoves.push_back(rootMove);
-            }
+            RootMove rootMove = {};
+            rootMove.move = move;
+            rootMoves.push_back(rootMove);
         }
     }
 
@@ -1638,7 +1864,7 @@ void Worker::tdatagen() {
     SearchStack* stack = &stackList[STACK_OVERHEAD];
 
     Board boardList[MAX_PLY + 2];
-    boardList[0] = rootBoard;
+    std::fill(std::begin(boardList), std::end(boardList), rootBoard);
     Board* board = &boardList[0];
 
     movepickers.resize(MAX_PLY + 2);
@@ -1688,7 +1914,7 @@ void Worker::tdatagen() {
             sortRootMoves();
 
             // Stop if we need to
-            if (stopped.load(std::memory_order_relaxed) || exiting || searchData.nodesSearched.load(std::memory_order_relaxed) >= searchParameters.nodes)
+            if (stopped.load(std::memory_order_relaxed) || exiting || (searchParameters.nodes && searchData.nodesSearched.load(std::memory_order_relaxed) >= searchParameters.nodes))
                 break;
 
             // Our window was too high, lower alpha for next iteration
@@ -1714,14 +1940,49 @@ void Worker::tdatagen() {
             delta *= aspirationWindowDeltaFactor;
         }
 
-        if (stopped.load(std::memory_order_relaxed) || exiting || searchData.nodesSearched.load(std::memory_order_relaxed) >= searchParameters.nodes)
+        if (stopped.load(std::memory_order_relaxed) || exiting || (searchParameters.nodes && searchData.nodesSearched.load(std::memory_order_relaxed) >= searchParameters.nodes))
             break;
 
         previousValue = rootMoves[0].value;
     }
 
     sortRootMoves();
-    printUCI(this);
+}
 
-    std::cout << "bestmove " << rootMoves[0].move.toString(UCI::Options.chess960.value) << std::endl;
+void Worker::tanalyse() {
+    std::vector<std::string>& positions = threadPool->analysePositions;
+
+    // Positions are handed out one at a time, every worker searches its own position single-threaded
+    size_t index;
+    while ((index = threadPool->analyseIndex.fetch_add(1, std::memory_order_relaxed)) < positions.size()) {
+        rootBoard.parseFen(positions[index], UCI::Options.chess960.value);
+        boardHistory.clear();
+        boardHistory.push_back(rootBoard.hashes.hash);
+        rootMoves.clear();
+
+        std::ostringstream result;
+        result << rootBoard.fen() << " | bestmove ";
+
+        MoveList moves;
+        generateLegalMoves(&rootBoard, moves);
+        if (moves.size() == 0) {
+            result << "0000 | score " << (rootBoard.checkers ? "mate 0" : "cp 0") << " | nodes 0 | pv";
+        }
+        else {
+            fixedSearch();
+            if (exiting)
+                return;
+
+            RootMove& rootMove = rootMoves[0];
+            uint64_t nodes = searchData.nodesSearched.load(std::memory_order_relaxed);
+            threadPool->analyseNodes.fetch_add(nodes, std::memory_order_relaxed);
+
+            result << rootMove.move.toString(UCI::Options.chess960.value) << " | score " << formatEval(rootMove.value) << " | depth " << rootMove.depth << " | nodes " << nodes << " | pv";
+            for (Move move : rootMove.pv)
+                result << " " << move.toString(UCI::Options.chess960.value);
+        }
+
+        std::lock_guard<std::mutex> lock(threadPool->analyseMutex);
+        *threadPool->analyseOutput << result.str() << "\n";
+    }
 }
@@ -18,16 +18,17 @@ extern int LMP_MARGIN[MAX_PLY][2];
 
 void initReductions();
 
-uint64_t perft(Board& board, Depth depth);
-
 struct SearchParameters {
     bool perft; // Perft (requires depth)
     bool genfens; // Are we running a genfens search
     int genfensSeed; // Seed for genfens
     int genfensFens; // Number of fens for genfens
-    std::string genfensBook;
+    bool analyse; // Analyse the positions of a file, one position per worker
+    bool selfplay; // Play self-play games for training data on every worker
+    int selfplayGames; // Number of self-play games over all workers
+    int selfplaySeed; // Seed for the random opening moves of self-play games
 
-    std::vector<Move> searchmoves; // TODO: Search only these moves at root
+    std::vector<Move> searchmoves; // Search only these moves at root
     bool ponder; // Search in pondering mode => after "ponderhit", continue on ponder move
     uint64_t wtime; // White's remaining time (ms)
     uint64_t btime; // Black's remaining time (ms)
@@ -36,7 +37,7 @@ struct SearchParameters {
     int movestogo; // Moves to the next time control
     Depth depth; // Search depth
     uint64_t nodes; // Search exactly this many nodes
-    int mate; // TODO: Search for mate in X moves
+    int mate; // Search for mate in X moves (checks and evasions only)
     uint64_t movetime; // Search exactly this many ms
     bool infinite; // Search forever (until a stop / quit command)
 
@@ -47,7 +48,10 @@ struct SearchParameters {
         genfens = false;
         genfensSeed = 0;
         genfensFens = 0;
-        genfensBook = "";
+        analyse = false;
+        selfplay = false;
+        selfplayGames = 0;
+        selfplaySeed = 0;
 
         searchmoves = std::vector<Move>();
         ponder = false;
@@ -74,6 +78,7 @@ struct SearchData {
 
     std::atomic_uint64_t nodesSearched;
     uint64_t tbHits;
+    uint64_t boardCopies;
 
     int64_t startTime;
     int64_t optTime;
@@ -85,6 +90,7 @@ struct SearchData {
         rootDepth = 0;
         nodesSearched = 0;
         tbHits = 0;
+        boardCopies = 0;
         startTime = 0;
         optTime = 0;
         maxTime = 0;
@@ -105,7 +105,9 @@ inline VecI16 mulhiEpi16(VecI16 x, VecI16 y) {
   return _mm512_mulhi_epi16(x, y);
 }
 
-#if defined(__AVX512VBMI2__)
+#if defined(__AVX512VNNI__)
+constexpr const char* DOT_PRODUCT_NAME = "avx512-vnni";
+
 inline VecI32 dpbusdEpi32(VecI32 sum, VecIu8 u, VecI8 i) {
   return _mm512_dpbusd_epi32(sum, u, i);
 }
@@ -113,6 +115,8 @@ inline VecI32 dpbusdEpi32x2(VecI32 sum, VecIu8 u, VecI8 i, VecIu8 u2, VecI8 i2)
   return _mm512_dpbusd_epi32(_mm512_dpbusd_epi32(sum, u, i), u2, i2);
 }
 #else
+constexpr const char* DOT_PRODUCT_NAME = "avx512-maddubs";
+
 inline VecI32 dpbusdEpi32(VecI32 sum, VecIu8 u, VecI8 i) {
   VecI32 sum32 = _mm512_madd_epi16(_mm512_maddubs_epi16(u, i), _mm512_set1_epi16(1));
   return _mm512_add_epi32(sum32, sum);
@@ -125,6 +129,18 @@ inline VecI32 dpbusdEpi32x2(VecI32 sum, VecIu8 u, VecI8 i, VecIu8 u2, VecI8 i2)
 }
 #endif
 
+inline VecI16 set1PairEpi16(int pair) {
+  return _mm512_set1_epi32(pair);
+}
+
+inline VecI32 dpwssdEpi32(VecI32 sum, VecI16 x, VecI16 y) {
+#if defined(__AVX512VNNI__)
+  return _mm512_dpwssd_epi32(sum, x, y);
+#else
+  return _mm512_add_epi32(_mm512_madd_epi16(x, y), sum);
+#endif
+}
+
 inline VecIu8 packusEpi16(VecI16 x, VecI16 y) {
   return _mm512_packus_epi16(x, y);
 }
@@ -227,6 +243,19 @@ inline void vecStoreI(VecI16* dest, VecI16 x) {
   _mm256_store_si256(dest, x);
 }
 
+#if defined(__AVXVNNI__)
+constexpr const char* DOT_PRODUCT_NAME = "avx-vnni";
+
+inline VecI32 dpbusdEpi32(VecI32 sum, VecIu8 u, VecI8 i) {
+  return _mm256_dpbusd_avx_epi32(sum, u, i);
+}
+
+inline VecI32 dpbusdEpi32x2(VecI32 sum, VecIu8 u, VecI8 i, VecIu8 u2, VecI8 i2) {
+  return _mm256_dpbusd_avx_epi32(_mm256_dpbusd_avx_epi32(sum, u, i), u2, i2);
+}
+#else
+constexpr const char* DOT_PRODUCT_NAME = "avx2-maddubs";
+
 inline VecI32 dpbusdEpi32(VecI32 sum, VecIu8 u, VecI8 i) {
   VecI32 sum32 = _mm256_madd_epi16(_mm256_maddubs_epi16(u, i), _mm256_set1_epi16(1));
   return _mm256_add_epi32(sum32, sum);
@@ -238,6 +267,19 @@ inline VecI32 dpbusdEpi32x2(VecI32 sum, VecIu8 u, VecI8 i, VecIu8 u2, VecI8 i2)
   VecI32 sum32 = _mm256_madd_epi16(_mm256_add_epi16(mul1, mul2), _mm256_set1_epi16(1));
   return _mm256_add_epi32(sum32, sum);
 }
+#endif
+
+inline VecI16 set1PairEpi16(int pair) {
+  return _mm256_set1_epi32(pair);
+}
+
+inline VecI32 dpwssdEpi32(VecI32 sum, VecI16 x, VecI16 y) {
+#if defined(__AVXVNNI__)
+  return _mm256_dpwssd_avx_epi32(sum, x, y);
+#else
+  return _mm256_add_epi32(_mm256_madd_epi16(x, y), sum);
+#endif
+}
 
 inline VecF cvtepi32Ps(VecI32 x) {
   return _mm256_cvtepi32_ps(x);
@@ -351,6 +393,8 @@ inline void vecStoreI(VecI16* dest, VecI16 x) {
 }
 
 #if defined(__SSSE3__)
+constexpr const char* DOT_PRODUCT_NAME = "ssse3-maddubs";
+
 inline VecI32 dpbusdEpi32(VecI32 sum, VecIu8 u, VecI8 i) {
   VecI32 sum32 = _mm_madd_epi16(_mm_maddubs_epi16(u, i), _mm_set1_epi16(1));
   return _mm_add_epi32(sum32, sum);
@@ -361,8 +405,18 @@ inline VecI32 dpbusdEpi32x2(VecI32 sum, VecIu8 u, VecI8 i, VecIu8 u2, VecI8 i2)
   VecI32 sum32 = _mm_madd_epi16(_mm_add_epi16(mul1, mul2), _mm_set1_epi16(1));
   return _mm_add_epi32(sum32, sum);
 }
+#else
+constexpr const char* DOT_PRODUCT_NAME = "scalar";
 #endif
 
+inline VecI16 set1PairEpi16(int pair) {
+  return _mm_set1_epi32(pair);
+}
+
+inline VecI32 dpwssdEpi32(VecI32 sum, VecI16 x, VecI16 y) {
+  return _mm_add_epi32(_mm_madd_epi16(x, y), sum);
+}
+
 inline VecF cvtepi32Ps(VecI32 x) {
   return _mm_cvtepi32_ps(x);
 }
@@ -475,6 +529,19 @@ inline int32x4_t madd(int16x8_t a, int16x8_t b) {
 }
 
 // SIMD dot-product
+#if defined(__ARM_FEATURE_MATMUL_INT8)
+constexpr const char* DOT_PRODUCT_NAME = "neon-usdot";
+
+inline VecI32 dpbusdEpi32(VecI32 sum, VecIu8 u, VecI8 i) {
+  return vusdotq_s32(sum, u, i);
+}
+
+inline VecI32 dpbusdEpi32x2(VecI32 sum, VecIu8 u, VecI8 i, VecIu8 u2, VecI8 i2) {
+  return vusdotq_s32(vusdotq_s32(sum, u, i), u2, i2);
+}
+#else
+constexpr const char* DOT_PRODUCT_NAME = "neon-maddubs";
+
 inline VecI32 dpbusdEpi32(VecI32 sum, VecIu8 u, VecI8 i) {
   int32x4_t sum32 = madd(maddubs(u, i), vdupq_n_s16(1));
   return vaddq_s32(sum32, sum);
@@ -486,6 +553,15 @@ inline VecI32 dpbusdEpi32x2(VecI32 sum, VecIu8 u, VecI8 i, VecIu8 u2, VecI8 i2)
   VecI32 sum32 = madd(vaddq_s16(mul1, mul2), vdupq_n_s16(1));
   return vaddq_s32(sum32, sum);
 }
+#endif
+
+inline VecI16 set1PairEpi16(int pair) {
+  return vreinterpretq_s16_s32(vdupq_n_s32(pair));
+}
+
+inline VecI32 dpwssdEpi32(VecI32 sum, VecI16 x, VecI16 y) {
+  return vaddq_s32(madd(x, y), sum);
+}
 
 // Pack and store
 inline VecIu8 packusEpi16(VecI16 x, VecI16 y) {
@@ -23,11 +23,18 @@ void Worker::startSearching() {
     }
     memcpy(&rootBoard, &threadPool->rootBoard, sizeof(Board));
     searchParameters = threadPool->searchParameters;
+    independentSearch = searchParameters.genfens || searchParameters.analyse || searchParameters.selfplay;
 
     if (searchParameters.perft)
-        searchData.nodesSearched = perft(rootBoard, searchParameters.depth);
+        tperft();
     else if (searchParameters.genfens)
         tgenfens();
+    else if (searchParameters.mate)
+        tmatesearch();
+    else if (searchParameters.analyse)
+        tanalyse();
+    else if (searchParameters.selfplay)
+        tselfplay();
     else if (UCI::Options.datagen.value)
         tdatagen();
     else
@@ -69,4 +76,6 @@ void Worker::exit() {
 
 void Worker::ucinewgame() {
     history.initHistory();
+    nnue.threatRefreshStats.clear();
+    nnue.fusedUpdateStats.clear();
 }
\ No newline at end of file
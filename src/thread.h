@@ -8,6 +8,7 @@
 #include <map>
 #include <atomic>
 #include <array>
+#include <ostream>
 
 #ifdef USE_NUMA
 #include <sched.h>
@@ -20,6 +21,8 @@
 #include "nnue.h"
 #include "tt.h"
 
+class OpeningBook;
+
 inline bool shouldConfigureNuma(int numThreads) {
 #ifdef USE_NUMA
     if (numa_available() == -1) {
@@ -195,6 +198,7 @@ public:
     bool searching = false;
     std::atomic_bool stopped = false;
     bool exiting = false;
+    bool independentSearch = false; // Every worker runs its own searches and only stops itself
 
     SearchData searchData;
     SearchParameters searchParameters;
@@ -202,6 +206,7 @@ public:
     NNUE nnue;
 
     ThreadPool* threadPool;
+    TranspositionTable* tt = &TT; // genfens verifies its FENs on a private table
 
     int threadId;
     bool mainThread;
@@ -224,10 +229,15 @@ public:
     void ucinewgame();
 
     void tdatagen();
+    void fixedSearch();
 
 private:
 
     void tgenfens();
+    void tperft();
+    void tmatesearch();
+    void tanalyse();
+    void tselfplay();
 
     void tsearch();
     void iterativeDeepening();
@@ -248,6 +258,8 @@ private:
     template <NodeType nodeType>
     Eval qsearch(Board* board, SearchStack* stack, Eval alpha, Eval beta);
 
+    Eval mateSearch(Board* board, SearchStack* stack, int depth, Eval alpha, Eval beta);
+
 };
 
 static_assert(sizeof(Worker) % 64 == 0, "sizeof(Worker) must be a multiple of 64");
@@ -264,6 +276,24 @@ public:
     std::vector<Hash> rootBoardHistory;
 
     std::atomic<size_t> startedThreads;
+    std::atomic<int> perftRootIndex; // Next root move to hand out to a perft worker
+
+    OpeningBook* genfensBook = nullptr;
+    std::atomic<int> genfensIndex; // Next FEN to hand out to a genfens worker
+    std::vector<std::string> genfensResults; // Finished FENs waiting for all lower indices to be printed
+    size_t genfensPrinted;
+    std::mutex genfensMutex;
+
+    std::vector<std::string> analysePositions;
+    std::atomic<size_t> analyseIndex; // Next position to hand out to an analysing worker
+    std::atomic<uint64_t> analyseNodes;
+    std::ostream* analyseOutput = nullptr;
+    std::mutex analyseMutex;
+
+    std::string selfplayOutput; // Every worker writes its games to <selfplayOutput>_<threadId>.bin
+    std::atomic<int> selfplayGameIndex; // Next game to hand out to a self-play worker
+    std::atomic<int> selfplayGamesPlayed;
+    std::atomic<uint64_t> selfplayPositions;
 
     std::vector<NetworkData*> networkWeights;
     std::vector<SharedHistory*> sharedHistories;
@@ -387,6 +417,28 @@ public:
         rootBoardHistory = std::move(boardHistory);
         searchParameters = std::move(parameters);
 
+        if (searchParameters.perft) {
+            PERFT_TT.resize(PERFT_TABLE_SIZE);
+            perftRootIndex = 0;
+        }
+
+        if (searchParameters.genfens) {
+            genfensIndex = 0;
+            genfensResults.assign(searchParameters.genfensFens, std::string());
+            genfensPrinted = 0;
+        }
+
+        if (searchParameters.analyse) {
+            analyseIndex = 0;
+            analyseNodes = 0;
+        }
+
+        if (searchParameters.selfplay) {
+            selfplayGameIndex = 0;
+            selfplayGamesPlayed = 0;
+            selfplayPositions = 0;
+        }
+
         for (auto& worker : workers) {
             worker.get()->rootMoves.clear();
             worker.get()->stopped.store(false, std::memory_order_relaxed);
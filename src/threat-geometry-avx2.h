@@ -0,0 +1,137 @@
+#pragma once
+
+#include <immintrin.h>
+#include <utility>
+
+namespace ThreatGeometry {
+
+    constexpr const char* NAME = "avx2";
+
+    // The 64 bytes are split into two halves, rays N to SE in lo and S to NW in hi
+    struct Vector {
+        __m256i lo;
+        __m256i hi;
+        Vector flip() const { return {hi, lo}; }
+    };
+
+    // Invalid squares of the permutation keep their top bit set, which makes pshufb return zero for them
+    struct Permutation {
+        Vector indexes;
+    };
+
+    inline Bitrays nonZeroMask(Vector v) {
+        uint32_t lo = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v.lo, _mm256_setzero_si256()));
+        uint32_t hi = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v.hi, _mm256_setzero_si256()));
+        return ~(uint64_t(hi) << 32 | lo);
+    }
+
+    inline Bitrays testMask(Vector v, const uint8_t* mask) {
+        const __m256i* m = reinterpret_cast<const __m256i*>(mask);
+        return nonZeroMask({_mm256_and_si256(v.lo, _mm256_loadu_si256(m)), _mm256_and_si256(v.hi, _mm256_loadu_si256(m + 1))});
+    }
+
+    // One byte per bit of the mask, 0xFF where the bit is set
+    inline __m256i expandMask(uint32_t mask) {
+        const __m256i byteOfBit = _mm256_set_epi64x(0x0303030303030303ULL, 0x0202020202020202ULL, 0x0101010101010101ULL, 0);
+        const __m256i bitOfByte = _mm256_set1_epi64x(0x8040201008040201ULL);
+        __m256i bytes = _mm256_shuffle_epi8(_mm256_set1_epi32(mask), byteOfBit);
+        return _mm256_cmpeq_epi8(_mm256_and_si256(bytes, bitOfByte), bitOfByte);
+    }
+
+    // Picks table[index & 63] for every index byte, or zero where the index has its top bit set
+    inline __m256i permuteBytes(Vector table, __m256i indexes) {
+        __m256i lane0 = _mm256_permute2x128_si256(table.lo, table.lo, 0x00);
+        __m256i lane1 = _mm256_permute2x128_si256(table.lo, table.lo, 0x11);
+        __m256i lane2 = _mm256_permute2x128_si256(table.hi, table.hi, 0x00);
+        __m256i lane3 = _mm256_permute2x128_si256(table.hi, table.hi, 0x11);
+        __m256i selectLane = _mm256_slli_epi16(indexes, 3);
+        __m256i fromLo = _mm256_blendv_epi8(_mm256_shuffle_epi8(lane0, indexes), _mm256_shuffle_epi8(lane1, indexes), selectLane);
+        __m256i fromHi = _mm256_blendv_epi8(_mm256_shuffle_epi8(lane2, indexes), _mm256_shuffle_epi8(lane3, indexes), selectLane);
+        return _mm256_blendv_epi8(fromLo, fromHi, _mm256_slli_epi16(indexes, 2));
+    }
+
+    // Without a byte compress on AVX2 the few selected bytes are read back one by one
+    struct Bytes {
+        alignas(32) uint8_t data[64];
+        Bytes(Vector v) {
+            _mm256_store_si256(reinterpret_cast<__m256i*>(data), v.lo);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(data) + 1, v.hi);
+        }
+    };
+
+    inline Permutation permutationFor(Square focus) {
+        const __m256i* table = reinterpret_cast<const __m256i*>(PERMUTATION_TABLE[focus].data());
+        return {{_mm256_loadu_si256(table), _mm256_loadu_si256(table + 1)}};
+    }
+
+    inline Vector colouredMailbox(const uint8_t* pieces, uint64_t black, Square ignore) {
+        const __m256i eight = _mm256_set1_epi8(8);
+        const __m256i* p = reinterpret_cast<const __m256i*>(pieces);
+        __m256i lo = _mm256_loadu_si256(p);
+        __m256i hi = _mm256_loadu_si256(p + 1);
+        lo = _mm256_add_epi8(lo, _mm256_and_si256(expandMask(uint32_t(black)), eight));
+        hi = _mm256_add_epi8(hi, _mm256_and_si256(expandMask(uint32_t(black >> 32)), eight));
+        if (ignore != NO_SQUARE) {
+            const __m256i none = _mm256_set1_epi8(Piece::NONE);
+            if (ignore < 32)
+                lo = _mm256_blendv_epi8(lo, none, expandMask(1U << ignore));
+            else
+                hi = _mm256_blendv_epi8(hi, none, expandMask(1U << (ignore - 32)));
+        }
+        return {lo, hi};
+    }
+
+    inline std::pair<Vector, Vector> permuteMailbox(const Permutation& permutation, Vector mailbox) {
+        __m256i lut = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(PIECE_TO_BIT.data())));
+        Vector permuted = {permuteBytes(mailbox, permutation.indexes.lo), permuteBytes(mailbox, permutation.indexes.hi)};
+        __m256i invalidLo = _mm256_and_si256(permutation.indexes.lo, _mm256_set1_epi8(char(0x80)));
+        __m256i invalidHi = _mm256_and_si256(permutation.indexes.hi, _mm256_set1_epi8(char(0x80)));
+        Vector bits = {_mm256_shuffle_epi8(lut, _mm256_or_si256(permuted.lo, invalidLo)), _mm256_shuffle_epi8(lut, _mm256_or_si256(permuted.hi, invalidHi))};
+        return {permuted, bits};
+    }
+
+    inline Bitrays closestOccupied(Vector bits) {
+        Bitrays occupied = nonZeroMask(bits);
+        Bitrays o = occupied | 0x8181818181818181ULL;
+        return (o ^ (o - 0x0303030303030303ULL)) & occupied;
+    }
+
+    inline Bitrays incomingAttackers(Vector bits, Bitrays closest) {
+        return testMask(bits, INCOMING_THREATS_MASK.data()) & closest;
+    }
+
+    inline Bitrays incomingSliders(Vector bits, Bitrays closest) {
+        return testMask(bits, INCOMING_SLIDERS_MASK.data()) & closest & 0xFEFEFEFEFEFEFEFEULL;
+    }
+
+    template<bool outgoing>
+    inline int pushFocusThreats(void* dst, Vector indexes, Vector pieces, Bitrays br, uint8_t focusPiece, uint8_t focusSquare) {
+        Bytes otherSq(indexes), otherPiece(pieces);
+        uint32_t focus = focusPiece | (focusSquare << 8);
+        uint32_t* out = static_cast<uint32_t*>(dst);
+        int count = 0;
+        while (br) {
+            int i = __builtin_ctzll(br);
+            uint32_t other = otherPiece.data[i] | (otherSq.data[i] << 8);
+            out[count++] = outgoing ? focus | (other << 16) : other | (focus << 16);
+            br &= br - 1;
+        }
+        return count;
+    }
+
+    inline int pushDiscoveredThreats(void* dst, Vector indexes, Vector pieces, Bitrays sliders, Bitrays victims) {
+        Bytes sq(indexes), piece(pieces);
+        uint32_t* out = static_cast<uint32_t*>(dst);
+        int count = 0;
+        // Both masks hold one bit per valid ray, the victims ones rotated onto the ray of their slider
+        while (sliders) {
+            int i = __builtin_ctzll(sliders);
+            int j = __builtin_ctzll(victims) ^ 32;
+            out[count++] = piece.data[i] | (sq.data[i] << 8) | (piece.data[j] << 16) | (sq.data[j] << 24);
+            sliders &= sliders - 1;
+            victims &= victims - 1;
+        }
+        return count;
+    }
+
+}
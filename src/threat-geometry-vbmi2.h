@@ -5,6 +5,8 @@
 
 namespace ThreatGeometry {
 
+    constexpr const char* NAME = "avx512-vbmi2";
+
     struct Vector {
         __m512i raw;
         Vector flip() const { return {_mm512_shuffle_i64x2(raw, raw, 0b01001110)}; }
@@ -20,9 +22,12 @@ namespace ThreatGeometry {
         return {{indexes}, _mm512_testn_epi8_mask(indexes, _mm512_set1_epi8(0x80))};
     }
 
-    inline __m512i colouredMailbox(const uint8_t* pieces, uint64_t black) {
+    inline __m512i colouredMailbox(const uint8_t* pieces, uint64_t black, Square ignore) {
         __m512i types = _mm512_loadu_si512(pieces);
-        return _mm512_mask_add_epi8(types, black, types, _mm512_set1_epi8(8));
+        __m512i mailbox = _mm512_mask_add_epi8(types, black, types, _mm512_set1_epi8(8));
+        if (ignore != NO_SQUARE)
+            mailbox = _mm512_mask_blend_epi8(1ULL << ignore, mailbox, _mm512_set1_epi8(Piece::NONE));
+        return mailbox;
     }
 
     inline std::pair<Vector, Vector> permuteMailbox(const Permutation& permutation, __m512i mailbox) {
@@ -38,15 +43,6 @@ namespace ThreatGeometry {
         return (o ^ (o - 0x0303030303030303ULL)) & occupied;
     }
 
-    inline Bitrays rayFill(Bitrays br) {
-        br = (br + 0x7E7E7E7E7E7E7E7EULL) & 0x8080808080808080ULL;
-        return br - (br >> 7);
-    }
-
-    inline Bitrays outgoingThreats(uint8_t colouredPiece, Bitrays closest) {
-        return OUTGOING_THREATS[colouredPiece] & closest;
-    }
-
     inline Bitrays incomingAttackers(Vector bits, Bitrays closest) {
         return _mm512_test_epi8_mask(bits.raw, _mm512_loadu_si512(INCOMING_THREATS_MASK.data())) & closest;
     }
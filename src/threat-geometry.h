@@ -5,7 +5,7 @@
 
 #include "types.h"
 
-#if defined(__AVX512VBMI2__)
+#if defined(__AVX512VBMI2__) || defined(__AVX2__)
 
 namespace ThreatGeometry {
 
@@ -83,8 +83,21 @@ namespace ThreatGeometry {
         };
     }();
 
+    inline Bitrays rayFill(Bitrays br) {
+        br = (br + 0x7E7E7E7E7E7E7E7EULL) & 0x8080808080808080ULL;
+        return br - (br >> 7);
+    }
+
+    inline Bitrays outgoingThreats(uint8_t colouredPiece, Bitrays closest) {
+        return OUTGOING_THREATS[colouredPiece] & closest;
+    }
+
 }
 
+#if defined(__AVX512VBMI2__)
 #include "threat-geometry-vbmi2.h"
+#else
+#include "threat-geometry-avx2.h"
+#endif
 
 #endif
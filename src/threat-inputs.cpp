@@ -10,10 +10,8 @@ namespace ThreatInputs {
         // Bits 8-31: Base feature
         uint32_t data;
 
-        PiecePairData() {}
-        PiecePairData(bool excluded, bool semiExcluded, int baseFeature) {
-            data = (semiExcluded && !excluded) | (excluded << 1) | (baseFeature << 8);
-        }
+        constexpr PiecePairData() : data(0) {}
+        constexpr PiecePairData(bool excluded, bool semiExcluded, int baseFeature) : data((semiExcluded && !excluded) | (excluded << 1) | (baseFeature << 8)) {}
 
         bool isExcluded(Square attackingSquare, Square attackedSquare) const {
             bool lessThan = attackingSquare < attackedSquare;
@@ -22,11 +20,14 @@ namespace ThreatInputs {
         int baseFeature() const { return data >> 8; }
     };
 
-    PiecePairData PIECE_PAIR_LOOKUP[14][14];
-    uint16_t PIECE_OFFSET_LOOKUP[14][64];
-    uint8_t ATTACK_INDEX_LOOKUP[14][64][64];
+    struct Lookups {
+        PiecePairData piecePair[14][14];
+        uint16_t pieceOffset[14][64];
+        uint8_t attackIndex[14][64][64];
+    };
 
-    void initialise() {
+    constexpr Lookups LOOKUPS = [] {
+        Lookups lookups{};
 
         constexpr int PIECE_INTERACTION_MAP[6][6] = {
             {-1, 0, -1,  1, -1, -1},
@@ -40,17 +41,17 @@ namespace ThreatInputs {
         constexpr int PIECE_TARGET_COUNT[6] = { 4, 10, 8, 8, 10, 0 };
 
         int cumulativeOffset = 0;
-        int CUMULATIVE_PIECE_OFFSET[6][2];
-        int CUMULATIVE_OFFSET[6][2];
+        int CUMULATIVE_PIECE_OFFSET[6][2] = {};
+        int CUMULATIVE_OFFSET[6][2] = {};
         for (Color color = Color::WHITE; color <= Color::BLACK; ++color) {
             for (Piece piece = Piece::PAWN; piece < Piece::TOTAL; ++piece) {
                 int cumulativePieceOffset = 0;
 
                 for (Square origin = 0; origin < 64; origin++) {
-                    PIECE_OFFSET_LOOKUP[piece | (color << 3)][origin] = cumulativePieceOffset;
+                    lookups.pieceOffset[piece | (color << 3)][origin] = cumulativePieceOffset;
 
                     if (piece != Piece::PAWN || (origin >= 8 && origin < 56)) {
-                        Bitboard attacks = BB::attackedSquares(piece, origin, 0, color);
+                        Bitboard attacks = BB::pseudoAttacks(piece, origin, color);
                         cumulativePieceOffset += BB::popcount(attacks);
                     }
                 }
@@ -79,7 +80,7 @@ namespace ThreatInputs {
                         if (excluded)
                             featureBase = 0;
 
-                        PIECE_PAIR_LOOKUP[attackingPiece | (attackingColor << 3)][attackedPiece | (attackedColor << 3)] = PiecePairData(excluded, semiExcluded, featureBase);
+                        lookups.piecePair[attackingPiece | (attackingColor << 3)][attackedPiece | (attackedColor << 3)] = PiecePairData(excluded, semiExcluded, featureBase);
                     }
                 }
             }
@@ -88,14 +89,19 @@ namespace ThreatInputs {
         for (Piece piece = Piece::PAWN; piece < Piece::TOTAL; ++piece) {
             for (Color color = Color::WHITE; color <= Color::BLACK; ++color) {
                 for (Square origin = 0; origin < 64; origin++) {
-                    for (Square target = 0; target < 64; target++) {
-                        Bitboard attacks = BB::attackedSquares(piece, origin, 0, color);
-                        ATTACK_INDEX_LOOKUP[piece | (color << 3)][origin][target] = BB::popcount((bitboard(target) - 1) & attacks);
-                    }
+                    Bitboard attacks = BB::pseudoAttacks(piece, origin, color);
+                    for (Square target = 0; target < 64; target++)
+                        lookups.attackIndex[piece | (color << 3)][origin][target] = BB::popcount((bitboard(target) - 1) & attacks);
                 }
             }
         }
-    }
+
+        return lookups;
+    }();
+
+    constexpr auto& PIECE_PAIR_LOOKUP = LOOKUPS.piecePair;
+    constexpr auto& PIECE_OFFSET_LOOKUP = LOOKUPS.pieceOffset;
+    constexpr auto& ATTACK_INDEX_LOOKUP = LOOKUPS.attackIndex;
 
     template<Color side>
     int getThreatFeature(uint8_t attackingPiece, uint8_t attackedPiece, Square attackingSquare, Square attackedSquare, bool mirrored) {
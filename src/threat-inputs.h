@@ -45,8 +45,6 @@ namespace ThreatInputs {
     template<Color side>
     void addPawnPairDeltas(Board* board, const DirtyPiece& dirtyPiece, bool mirrored, FeatureList& adds, FeatureList& subs);
 
-    void initialise();
-
     template<Color side>
     int getThreatFeature(uint8_t attackingPiece, uint8_t attackedPiece, Square attackingSquare, Square attackedSquare, bool mirrored);
     int getPieceFeature(Piece piece, Square relativeSquare, Color relativeColor, uint8_t kingBucket);
@@ -18,7 +18,8 @@ int64_t getTime() {
 bool timeOver(SearchParameters& parameters, SearchData& data) {
     if (parameters.ponder)
         return false;
-    return (data.maxTime && (data.nodesSearched.load(std::memory_order_relaxed) % 1024) == 0 && getTime() >= data.maxTime) || (parameters.nodes && data.nodesSearched.load(std::memory_order_relaxed) >= parameters.nodes * (1 + 9 * UCI::Options.datagen.value));
+    // Datagen searches use the node limit as a soft limit, with a hard limit of ten times that
+    return (data.maxTime && (data.nodesSearched.load(std::memory_order_relaxed) % 1024) == 0 && getTime() >= data.maxTime) || (parameters.nodes && data.nodesSearched.load(std::memory_order_relaxed) >= parameters.nodes * (1 + 9 * (UCI::Options.datagen.value || parameters.selfplay)));
 }
 
 bool timeOverDepthCleared(SearchParameters& parameters, SearchData& data, double factor) {
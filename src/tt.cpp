@@ -50,3 +50,4 @@ TTEntry* TranspositionTable::probe(Hash hash, bool* found) {
 
 uint8_t TT_GENERATION_COUNTER = 0;
 TranspositionTable TT;
+PerftTable PERFT_TT;
@@ -117,8 +117,7 @@ public:
         return count / CLUSTER_SIZE;
     }
 
-    void clear() {
-        size_t threadCount = UCI::Options.threads.value;
+    void clear(size_t threadCount = UCI::Options.threads.value) {
         std::vector<std::thread> ts;
 
         for (size_t thread = 0; thread < threadCount; thread++) {
@@ -137,3 +136,72 @@ public:
 };
 
 extern TranspositionTable TT;
+
+// The perft table has its own fixed size, independent of the Hash option, and is only allocated while a perft runs
+constexpr size_t PERFT_TABLE_SIZE = 64; // MB
+
+// Perft subtree counts, keyed by the position hash and the remaining depth
+struct PerftEntry {
+    uint64_t key = 0; // Stored XORed with the count, so entries torn by concurrent writes don't match
+    uint64_t nodes = 0;
+};
+
+class PerftTable {
+
+    PerftEntry* table = nullptr;
+    size_t entryCount = 0;
+
+    static Hash key(Hash hash, Depth depth) {
+        return hash ^ (uint64_t(depth) * 0x9E3779B97F4A7C15ULL);
+    }
+
+    size_t index(Hash key) {
+        __extension__ using uint128 = unsigned __int128;
+        return ((uint128)key * (uint128)entryCount) >> 64;
+    }
+
+public:
+
+    ~PerftTable() {
+        release();
+    }
+
+    void release() {
+        if (table)
+            alignedFree(table);
+        table = nullptr;
+        entryCount = 0;
+    }
+
+    void resize(size_t mb) {
+        size_t newEntryCount = mb * 1024 * 1024 / sizeof(PerftEntry);
+        if (newEntryCount == entryCount)
+            return;
+
+        release();
+
+        entryCount = newEntryCount;
+        table = static_cast<PerftEntry*>(alignedAlloc(64, entryCount * sizeof(PerftEntry)));
+        std::memset(static_cast<void*>(table), 0, entryCount * sizeof(PerftEntry));
+    }
+
+    bool probe(Hash hash, Depth depth, uint64_t* nodes) {
+        Hash k = key(hash, depth);
+        PerftEntry* entry = &table[index(k)];
+        uint64_t entryNodes = entry->nodes;
+        if ((entry->key ^ entryNodes) != k)
+            return false;
+        *nodes = entryNodes;
+        return true;
+    }
+
+    void store(Hash hash, Depth depth, uint64_t nodes) {
+        Hash k = key(hash, depth);
+        PerftEntry* entry = &table[index(k)];
+        entry->key = k ^ nodes;
+        entry->nodes = nodes;
+    }
+
+};
+
+extern PerftTable PERFT_TT;
@@ -264,6 +264,8 @@ public:
         return MAX;
     }
 
+    T* begin() { return elements; }
+    T* end() { return elements + _size; }
     const T* begin() const { return elements; }
     const T* end() const { return elements + _size; }
 
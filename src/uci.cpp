@@ -5,8 +5,12 @@
 #include <iostream>
 #include <deque>
 #include <sstream>
+#include <fstream>
 #include <algorithm>
 #include <tuple>
+#include <memory>
+#include <random>
+#include <filesystem>
 
 #include "board.h"
 #include "uci.h"
@@ -21,6 +25,13 @@
 #include "fathom/src/tbprobe.h"
 #include "debug.h"
 #include "bench.h"
+#include "threat-geometry.h"
+#include "magic.h"
+#include "datagen.h"
+
+#if defined(ARCH_X86)
+#include <x86intrin.h>
+#endif
 
 namespace UCI {
     UCIOptions Options;
@@ -55,6 +66,7 @@ void bench(Board& board, std::vector<Hash>& boardHistory) {
     UCI::Options.minimal.value = true;
 
     uint64_t nodes = 0;
+    uint64_t boardCopies = 0;
     int64_t elapsed = 0;
     int position = 1;
     int totalPositions = Bench::BENCH_POSITIONS.size();
@@ -82,15 +94,39 @@ void bench(Board& board, std::vector<Hash>& boardHistory) {
         threads.startSearching(board, boardHistory, parameters);
         threads.waitForSearchFinished();
         nodes += threads.nodesSearched();
+        for (auto& worker : threads.workers)
+            boardCopies += worker.get()->searchData.boardCopies;
 
         std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
         elapsed += std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
     }
 
+    ThreatRefreshStats refreshStats;
+    refreshStats.clear();
+    FusedUpdateStats fusedStats;
+    fusedStats.clear();
+    QuietOrderingStats quietStats;
+    quietStats.clear();
+    for (auto& worker : threads.workers) {
+        quietStats.scored += worker.get()->history.quietOrderingStats.scored;
+        quietStats.returned += worker.get()->history.quietOrderingStats.returned;
+        refreshStats.refreshes += worker.get()->nnue.threatRefreshStats.refreshes;
+        refreshStats.rowsApplied += worker.get()->nnue.threatRefreshStats.rowsApplied;
+        refreshStats.rowsFromScratch += worker.get()->nnue.threatRefreshStats.rowsFromScratch;
+        fusedStats.updates += worker.get()->nnue.fusedUpdateStats.updates;
+        fusedStats.plies += worker.get()->nnue.fusedUpdateStats.plies;
+        fusedStats.rowsApplied += worker.get()->nnue.fusedUpdateStats.rowsApplied;
+        fusedStats.rowsCancelled += worker.get()->nnue.fusedUpdateStats.rowsCancelled;
+    }
+
     std::cerr << "\n==========================="
         << "\nTotal time (ms) : " << elapsed
         << "\nNodes searched  : " << nodes
-        << "\nNodes/second    : " << 1000 * nodes / elapsed << std::endl;
+        << "\nNodes/second    : " << 1000 * nodes / elapsed
+        << "\nBoard copies    : " << boardCopies << " (" << BOARD_STATE_SIZE << " of " << sizeof(Board) << " bytes each, " << BOARD_STATE_SIZE * boardCopies / std::max<uint64_t>(1, nodes) << " bytes per node)"
+        << "\nQuiet moves     : " << quietStats.scored << " scored, " << quietStats.returned << " returned (" << 100.0 * (quietStats.scored - quietStats.returned) / std::max<uint64_t>(1, quietStats.scored) << "% never searched)"
+        << "\nThreat refreshes: " << refreshStats.refreshes << " (" << refreshStats.rowsApplied << " of " << refreshStats.rowsFromScratch << " rows applied)"
+        << "\nFused updates   : " << fusedStats.updates << " (" << fusedStats.plies << " plies, " << fusedStats.rowsApplied << " rows applied, " << fusedStats.rowsCancelled << " cancelled)" << std::endl;
 
     UCI::Options.minimal.value = minimal;
 }
@@ -175,50 +211,74 @@ std::vector<std::string> splitString(const std::string& input, char delimiter) {
     return tokens;
 }
 
-void position(std::string line, Board& board, std::vector<Hash>& boardHistory) {
-    std::istringstream iss(line);
-    std::string token;
-    iss >> token;
+// Result of the last position command. GUIs resend the whole game before every go, so a command that only appends moves continues from here
+struct PositionCache {
+    std::string base;
+    bool chess960 = false;
+    std::string moves;
+    Board board;
+    std::vector<Hash> boardHistory;
+};
 
-    // Set up startpos or moves
-    if (token == "startpos") {
-        board.startpos();
-    }
-    else if (token == "fen") {
-        board.parseFen(iss, UCI::Options.chess960.value);
-    }
-    else {
-        std::cout << "Not a valid position, exiting" << std::endl;
-        exit(-1);
-    }
+PositionCache positionCache;
 
-    boardHistory.clear();
-    boardHistory.reserve(MAX_PLY);
-    boardHistory.push_back(board.hashes.hash);
+void position(std::string line, Board& board, std::vector<Hash>& boardHistory) {
+    size_t movesStart = line.find(" moves");
+    std::string base = line.substr(0, movesStart);
+    std::string moves = movesStart == std::string::npos ? "" : line.substr(movesStart + 6);
+
+    PositionCache& cache = positionCache;
+    size_t appliedMoves = cache.moves.size();
+    bool extendsCache = base == cache.base && UCI::Options.chess960.value == cache.chess960
+        && moves.compare(0, appliedMoves, cache.moves) == 0 && (moves.size() == appliedMoves || moves[appliedMoves] == ' ');
+
+    if (!extendsCache) {
+        std::istringstream iss(base);
+        std::string token;
+        iss >> token;
+
+        // Set up startpos or moves
+        if (token == "startpos") {
+            cache.board.startpos();
+        }
+        else if (token == "fen") {
+            cache.board.parseFen(iss, UCI::Options.chess960.value);
+        }
+        else {
+            std::cout << "Not a valid position, exiting" << std::endl;
+            exit(-1);
+        }
 
-    // Make further moves
-    iss >> token;
-    if (token != "moves")
-        return;
+        cache.base = base;
+        cache.chess960 = UCI::Options.chess960.value;
+        cache.boardHistory.clear();
+        cache.boardHistory.reserve(MAX_PLY);
+        cache.boardHistory.push_back(cache.board.hashes.hash);
+        appliedMoves = 0;
+    }
 
-    UCI::nnue.reset(&board);
-    int moveCount = 0;
+    // Make the new moves, the search resets the NNUE accumulators anyway
+    const char* move = moves.c_str() + appliedMoves;
+    while (*move) {
+        if (*move == ' ') {
+            move++;
+            continue;
+        }
 
-    while (iss >> token) {
-        Move m = stringToMove(token.c_str(), &board);
-        
-        assert(board.isLegal(m));
+        Move m = stringToMove(move, &cache.board);
 
-        Board boardCopy = board;
-        boardCopy.doMove(m, board.hashAfter(m).first, &UCI::nnue);
-        boardHistory.push_back(boardCopy.hashes.hash);
+        assert(cache.board.isLegal(m));
 
-        if (moveCount++ > 200) {
-            UCI::nnue.reset(&boardCopy);
-        }
+        cache.board.doMove<false>(m, cache.board.hashAfter(m).first, nullptr);
+        cache.boardHistory.push_back(cache.board.hashes.hash);
 
-        board = boardCopy;
+        while (*move && *move != ' ')
+            move++;
     }
+    cache.moves = moves;
+
+    board = cache.board;
+    boardHistory = cache.boardHistory;
 }
 
 struct setUciOption
@@ -304,6 +364,11 @@ void go(std::string line, Board& board, std::vector<Hash>& boardHistory) {
             parameters.nodes = std::stoi(token);
         }
 
+        if (matchesToken(token, "mate")) {
+            nextToken(&line, &token);
+            parameters.mate = std::stoi(token);
+        }
+
         if (matchesToken(token, "infinite")) {
             parameters.infinite = true;
         }
@@ -338,6 +403,15 @@ void go(std::string line, Board& board, std::vector<Hash>& boardHistory) {
             parameters.movestogo = std::stoi(token);
         }
 
+        if (matchesToken(token, "searchmoves")) {
+            // The moves run until the next parameter
+            auto isMove = [](const std::string& text) {
+                return text.size() >= 4 && text[0] >= 'a' && text[0] <= 'h' && text[1] >= '1' && text[1] <= '8' && text[2] >= 'a' && text[2] <= 'h' && text[3] >= '1' && text[3] <= '8';
+            };
+            while (isMove(line) && nextToken(&line, &token))
+                parameters.searchmoves.push_back(stringToMove(token.c_str(), &board));
+        }
+
     }
 
     TT.newSearch();
@@ -410,10 +484,758 @@ void speedtest(Board& board, std::vector<Hash>& boardHistory) {
     std::cout << "NPS: " << (1000ULL * nodes / time) << std::endl;
 }
 
-void genfens(std::string params, Board& board, std::vector<Hash>& boardHistory) {
+// Timestamp counter on x86 (reference ticks at a fixed rate, not core clock cycles), nanoseconds elsewhere
+#if defined(ARCH_X86)
+constexpr const char* TICKS_UNIT = "TSC ticks";
+#else
+constexpr const char* TICKS_UNIT = "ns";
+#endif
+
+uint64_t readTicks() {
+#if defined(ARCH_X86)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// Applies the rows either with one tiled kernel call or with one call (a full sweep of the accumulator) per row
+template<FtType type>
+uint64_t accumulatorUpdateTicks(NNUE* nnue, const ThreatInputs::FeatureList& adds, const ThreatInputs::FeatureList& subs, int repetitions, bool perRow) {
+    int16_t(*state)[L1_SIZE] = nnue->accumulatorStack[0].threatState;
+    ThreatInputs::FeatureList none;
+
+    uint64_t start = readTicks();
+    for (int r = 0; r < repetitions; r++) {
+        if (perRow) {
+            for (int feature : subs) {
+                ThreatInputs::FeatureList row;
+                row.add(feature);
+                nnue->applyRows<type, Color::WHITE>(state, state, none, row);
+            }
+            for (int feature : adds) {
+                ThreatInputs::FeatureList row;
+                row.add(feature);
+                nnue->applyRows<type, Color::WHITE>(state, state, row, none);
+            }
+        }
+        else {
+            nnue->applyRows<type, Color::WHITE>(state, state, adds, subs);
+        }
+    }
+    return (readTicks() - start) / repetitions;
+}
+
+void evalbench(std::string params) {
+    std::istringstream iss(params);
+    std::string token;
+    int iterations = 1000;
+
+    iss >> token;
+    if (iss >> token)
+        iterations = std::stoi(token);
+
+    int numThreads = UCI::Options.threads.value;
+
+    std::vector<Board> positions;
+    int i = 0;
+    for (const std::string& fen : Bench::BENCH_POSITIONS) {
+        Board board;
+        board.parseFen(fen, i++ >= 44);
+        positions.push_back(board);
+    }
+    int positionCount = positions.size();
+
+    // Make sure both paths agree before measuring them
+    std::unique_ptr<NNUE> referenceNNUE = std::make_unique<NNUE>(globalNetworkData);
+    std::vector<Board*> referenceBoards;
+    for (Board& board : positions)
+        referenceBoards.push_back(&board);
+    std::vector<Eval> batchResults(positionCount);
+    referenceNNUE->evaluateBatch(referenceBoards.data(), positionCount, batchResults.data());
+
+    int mismatches = 0;
+    for (int p = 0; p < positionCount; p++) {
+        referenceNNUE->reset(&positions[p]);
+        mismatches += referenceNNUE->evaluate(&positions[p]) != batchResults[p];
+    }
+
+    // Forward pass only: the accumulators are computed once, then each position is evaluated repeatedly
+    uint64_t forwardTicks = 0;
+    for (int p = 0; p < positionCount; p++) {
+        referenceNNUE->reset(&positions[p]);
+        uint64_t start = readTicks();
+        for (int iteration = 0; iteration < iterations; iteration++)
+            referenceNNUE->evaluate(&positions[p]);
+        forwardTicks += readTicks() - start;
+    }
+
+    // Accumulator kernels for typical update sizes: moves, captures, castling, multi-ply updates and refreshes
+    constexpr int KERNEL_UPDATE_SIZES[][2] = { { 1, 1 }, { 1, 2 }, { 2, 2 }, { 8, 8 }, { 16, 16 }, { 32, 0 }, { 96, 0 } };
+    std::mt19937 rng(0);
+    std::ostringstream kernelResults;
+    for (auto& size : KERNEL_UPDATE_SIZES) {
+        ThreatInputs::FeatureList psqAdds, psqSubs, threatAdds, threatSubs;
+        for (int k = 0; k < size[0]; k++) {
+            psqAdds.add(rng() % (768 * KING_BUCKETS));
+            threatAdds.add(rng() % (ThreatInputs::PAWN_PAIR_FEATURE_COUNT + ThreatInputs::FEATURE_COUNT));
+        }
+        for (int k = 0; k < size[1]; k++) {
+            psqSubs.add(rng() % (768 * KING_BUCKETS));
+            threatSubs.add(rng() % (ThreatInputs::PAWN_PAIR_FEATURE_COUNT + ThreatInputs::FEATURE_COUNT));
+        }
+
+        kernelResults << "  " << size[0] << " adds, " << size[1] << " subs: psq "
+            << accumulatorUpdateTicks<FtType::Psq>(referenceNNUE.get(), psqAdds, psqSubs, iterations, false) << " / "
+            << accumulatorUpdateTicks<FtType::Psq>(referenceNNUE.get(), psqAdds, psqSubs, iterations, true) << ", threat "
+            << accumulatorUpdateTicks<FtType::Threat>(referenceNNUE.get(), threatAdds, threatSubs, iterations, false) << " / "
+            << accumulatorUpdateTicks<FtType::Threat>(referenceNNUE.get(), threatAdds, threatSubs, iterations, true) << std::endl;
+    }
+
+    auto runThreads = [&](bool batched) {
+        std::vector<std::thread> ts;
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+        for (int thread = 0; thread < numThreads; thread++) {
+            ts.push_back(std::thread([&]() {
+                std::unique_ptr<NNUE> nnue = std::make_unique<NNUE>(globalNetworkData);
+                std::vector<Board> boards = positions;
+                std::vector<Board*> boardPointers;
+                for (Board& board : boards)
+                    boardPointers.push_back(&board);
+                std::vector<Eval> results(positionCount);
+
+                for (int iteration = 0; iteration < iterations; iteration++) {
+                    if (batched) {
+                        nnue->evaluateBatch(boardPointers.data(), positionCount, results.data());
+                    }
+                    else {
+                        for (int p = 0; p < positionCount; p++) {
+                            nnue->reset(boardPointers[p]);
+                            results[p] = nnue->evaluate(boardPointers[p]);
+                        }
+                    }
+                }
+            }));
+        }
+        for (auto& t : ts) {
+            t.join();
+        }
+
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        return std::max<int64_t>(1, std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count());
+    };
+
+    uint64_t evaluations = static_cast<uint64_t>(numThreads) * iterations * positionCount;
+    int64_t singleTime = runThreads(false);
+    int64_t batchTime = runThreads(true);
+
+    std::cout << std::endl << "--- Evalbench finished ---" << std::endl;
+    std::cout << "Threads: " << numThreads << std::endl;
+    std::cout << "Batch size: " << EVAL_BATCH_SIZE << std::endl;
+    std::cout << "Evaluations: " << evaluations << std::endl;
+    std::cout << "Mismatches: " << mismatches << std::endl;
+    std::cout << "Dot product: " << DOT_PRODUCT_NAME << std::endl;
+    std::cout << "Forward pass: " << forwardTicks / (static_cast<uint64_t>(iterations) * positionCount) << " " << TICKS_UNIT << " per evaluate" << std::endl;
+    std::cout << "Accumulator updates (" << TICKS_UNIT << ", tiled / one pass per row, tile of " << ACCUMULATOR_TILE << " vectors):" << std::endl << kernelResults.str();
+    std::cout << "Single positions/second: " << (1000000ULL * evaluations / singleTime) << " (" << (1000000ULL * evaluations / singleTime / numThreads) << " per core)" << std::endl;
+    std::cout << "Batch positions/second: " << (1000000ULL * evaluations / batchTime) << " (" << (1000000ULL * evaluations / batchTime / numThreads) << " per core)" << std::endl;
+}
+
+void threatbench(std::string params) {
+    std::istringstream iss(params);
+    std::string token;
+    int iterations = 1000;
+
+    iss >> token;
+    if (iss >> token)
+        iterations = std::stoi(token);
+
+#if defined(__AVX512VBMI2__) || defined(__AVX2__)
+    const char* geometryName = ThreatGeometry::NAME;
+#else
+    const char* geometryName = "none";
+#endif
+
+    std::unique_ptr<NNUE> nnue = std::make_unique<NNUE>(globalNetworkData);
+    Board board;
+
+    auto collect = [&](Square square, bool geometry, std::vector<uint32_t>* threats) {
+        Accumulator* acc = &nnue->accumulatorStack[nnue->currentAccumulator];
+        acc->numThreatsAdded = 0;
+        acc->numThreatsRemoved = 0;
+        if (geometry)
+            board.collectPieceThreats<true>(square, nnue.get());
+        else
+            board.collectPieceThreats<false>(square, nnue.get());
+
+        if (threats) {
+            // Only threats that map to a feature matter, the geometry skips the excluded king threats altogether
+            auto push = [&](const DirtyThreat& dt, bool removed) {
+                bool whiteFeature = ThreatInputs::getThreatFeature<Color::WHITE>(dt.piece, dt.attackedPiece, dt.square, dt.attackedSquare, false) != ThreatInputs::FEATURE_COUNT;
+                bool blackFeature = ThreatInputs::getThreatFeature<Color::BLACK>(dt.piece, dt.attackedPiece, dt.square, dt.attackedSquare, false) != ThreatInputs::FEATURE_COUNT;
+                if (!whiteFeature && !blackFeature)
+                    return;
+                uint32_t packed;
+                std::memcpy(&packed, &dt, sizeof(packed));
+                // Discovered threats end up in the opposite list
+                threats->push_back(removed ? ~packed : packed);
+            };
+            threats->clear();
+            for (int i = 0; i < acc->numThreatsAdded; i++)
+                push(acc->dirtyThreatsAdded[i], false);
+            for (int i = 0; i < acc->numThreatsRemoved; i++)
+                push(acc->dirtyThreatsRemoved[i], true);
+            std::sort(threats->begin(), threats->end());
+        }
+    };
+
+    uint64_t updates = 0, threatCount = 0, geometryTicks = 0, bitboardTicks = 0;
+    int mismatches = 0;
+    std::vector<uint32_t> geometryThreats, bitboardThreats;
+    int i = 0;
+    for (const std::string& fen : Bench::BENCH_POSITIONS) {
+        board.parseFen(fen, i++ >= 44);
+        nnue->reset(&board);
+
+        Bitboard occupied = board.byColor[Color::WHITE] | board.byColor[Color::BLACK];
+        while (occupied) {
+            Square square = popLSB(&occupied);
+
+            collect(square, true, &geometryThreats);
+            collect(square, false, &bitboardThreats);
+            mismatches += geometryThreats != bitboardThreats;
+            threatCount += bitboardThreats.size();
+
+            uint64_t start = readTicks();
+            for (int iteration = 0; iteration < iterations; iteration++)
+                collect(square, true, nullptr);
+            geometryTicks += readTicks() - start;
+
+            start = readTicks();
+            for (int iteration = 0; iteration < iterations; iteration++)
+                collect(square, false, nullptr);
+            bitboardTicks += readTicks() - start;
+
+            updates += iterations;
+        }
+    }
+
+    uint64_t pieces = updates / iterations;
+    std::cout << std::endl << "--- Threatbench finished ---" << std::endl;
+    std::cout << "Pieces: " << pieces << " (" << static_cast<double>(threatCount) / pieces << " threats each)" << std::endl;
+    std::cout << "Mismatches: " << mismatches << std::endl;
+    std::cout << "Threat geometry (" << geometryName << "): " << geometryTicks / updates << " " << TICKS_UNIT << " per piece update" << std::endl;
+    std::cout << "Bitboards: " << bitboardTicks / updates << " " << TICKS_UNIT << " per piece update" << std::endl;
+}
+
+// Runs the mate search on mate puzzles ("<fen> bm #N;" per line), without a file on the built-in ones
+void matebench(std::string params, Board& board, std::vector<Hash>& boardHistory) {
+    std::istringstream iss(params);
+    std::string token;
+    std::string path;
+
+    iss >> token;
+    std::getline(iss >> std::ws, path);
+
+    std::vector<std::string> puzzles;
+    if (!path.empty()) {
+        std::ifstream file(path);
+        if (!file.good()) {
+            std::cout << "info string unable to open " << path << std::endl;
+            return;
+        }
+        for (std::string line; std::getline(file, line);)
+            puzzles.push_back(line);
+    }
+    else {
+        puzzles = Bench::MATE_POSITIONS;
+    }
+
+    boardHistory.clear();
+    boardHistory.push_back(0);
+
+    bool minimal = UCI::Options.minimal.value;
+    UCI::Options.minimal.value = true;
+
+    threads.waitForSearchFinished();
+    threads.ucinewgame();
+
+    int total = 0, found = 0, best = 0;
+    uint64_t nodes = 0;
+    int64_t elapsed = 0;
+    for (const std::string& puzzle : puzzles) {
+        size_t bm = puzzle.find(" bm #");
+        if (bm == std::string::npos)
+            continue;
+        int mate = std::atoi(puzzle.c_str() + bm + 5);
+        // Only puzzles where the side to move mates
+        if (mate <= 0)
+            continue;
+
+        board.parseFen(puzzle.substr(0, bm), UCI::Options.chess960.value);
+        boardHistory[0] = board.hashes.hash;
+        SearchParameters parameters;
+        parameters.mate = mate;
+
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+        TT.newSearch();
+        threads.startSearching(board, boardHistory, parameters);
+        threads.waitForSearchFinished();
+
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        elapsed += std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+        nodes += threads.nodesSearched();
+
+        total++;
+        std::vector<RootMove>& rootMoves = threads.workers[0].get()->rootMoves;
+        if (!rootMoves.empty() && rootMoves[0].value >= EVAL_MATE_IN_MAX_PLY) {
+            found++;
+            best += (EVAL_MATE - rootMoves[0].value + 1) / 2 == mate;
+        }
+    }
+
+    std::cout << std::endl << "--- Matebench finished ---" << std::endl;
+    std::cout << "Puzzles: " << total << std::endl;
+    std::cout << "Mates found: " << found << " (" << best << " in the given number of moves)" << std::endl;
+    std::cout << "Nodes: " << nodes << std::endl;
+    std::cout << "Time (ms): " << elapsed / 1000 << std::endl;
+    std::cout << "Nodes/second: " << 1000000 * nodes / std::max<int64_t>(1, elapsed) << std::endl;
+
+    UCI::Options.minimal.value = minimal;
+}
+
+// Replays games move by move and measures the threat feature delta of every move in its three stages
+void threatprofile(std::string params) {
+    std::istringstream iss(params);
+    std::string token;
+    std::string gamesPath;
+    int plies = 40;
+
+    iss >> token;
+    while (iss >> token) {
+        if (token == "games")
+            std::getline(iss >> std::ws, gamesPath);
+        else if (token == "plies" && iss >> token)
+            plies = std::stoi(token);
+    }
+
+    // Every game is a "position" command line, without a file the bench positions are played out randomly
+    std::vector<std::pair<std::string, bool>> games;
+    if (!gamesPath.empty()) {
+        std::ifstream file(gamesPath);
+        if (!file.good()) {
+            std::cout << "info string unable to open " << gamesPath << std::endl;
+            return;
+        }
+        for (std::string line; std::getline(file, line);) {
+            if (line.rfind("position ", 0) == 0)
+                line = line.substr(9);
+            if (!line.empty())
+                games.emplace_back(line, UCI::Options.chess960.value);
+        }
+    }
+    else {
+        std::mt19937 rng(0);
+        Board board;
+        std::unique_ptr<NNUE> nnue = std::make_unique<NNUE>(globalNetworkData);
+        int i = 0;
+        for (const std::string& fen : Bench::BENCH_POSITIONS) {
+            bool chess960 = i++ >= 44;
+            board.parseFen(fen, chess960);
+            nnue->reset(&board);
+            std::string game = "fen " + board.fen() + " moves";
+            for (int ply = 0; ply < plies; ply++) {
+                MoveList legalMoves;
+                generateLegalMoves(&board, legalMoves);
+                if (legalMoves.size() == 0)
+                    break;
+                Move move = legalMoves[rng() % legalMoves.size()];
+                game += " " + move.toString(board.chess960);
+                Board boardCopy = board;
+                boardCopy.doMove(move, board.hashAfter(move).first, nnue.get());
+                board = boardCopy;
+                nnue->reset(&board);
+            }
+            games.emplace_back(game, chess960);
+        }
+    }
+
+    std::unique_ptr<NNUE> nnue = std::make_unique<NNUE>(globalNetworkData);
+    constexpr int LIMIT = 128;
+    std::array<uint64_t, LIMIT + 1> addedHistogram{}, removedHistogram{};
+    uint64_t moveCount = 0, refreshes = 0, detectionTicks = 0, indexingTicks = 0, applicationTicks = 0, rows = 0;
+    int peakAdded = 0, peakRemoved = 0;
+    std::string peakAddedMove, peakRemovedMove;
+
+    for (auto& [game, chess960] : games) {
+        Board board;
+        std::istringstream gameStream(game);
+        std::string setup, moveToken;
+        gameStream >> setup;
+        if (setup == "startpos") {
+            board.startpos();
+        }
+        else if (setup == "fen") {
+            std::string fen;
+            for (std::string fenToken; gameStream >> fenToken && fenToken != "moves";)
+                fen += fenToken + " ";
+            board.parseFen(fen, chess960);
+        }
+        else {
+            std::cout << "info string skipping game without a position: " << game << std::endl;
+            continue;
+        }
+        if (setup == "startpos" && gameStream >> moveToken && moveToken != "moves")
+            continue;
+
+        while (gameStream >> moveToken) {
+            Move move = stringToMove(moveToken.c_str(), &board);
+            if (!board.isPseudoLegal(move) || !board.isLegal(move)) {
+                std::cout << "info string illegal move " << moveToken << " in " << game << std::endl;
+                break;
+            }
+
+            // Start every move from a freshly refreshed accumulator, so only this move's delta is measured
+            nnue->reset(&board);
+            Board boardCopy = board;
+            Hash hash = board.hashAfter(move).first;
+
+            uint64_t start = readTicks();
+            boardCopy.doMove(move, hash, nnue.get());
+            detectionTicks += readTicks() - start;
+
+            Accumulator* inputAcc = &nnue->accumulatorStack[0];
+            Accumulator* outputAcc = &nnue->accumulatorStack[1];
+            int added = outputAcc->numThreatsAdded, removed = outputAcc->numThreatsRemoved;
+            addedHistogram[std::min(added, LIMIT)]++;
+            removedHistogram[std::min(removed, LIMIT)]++;
+            if (added > peakAdded) {
+                peakAdded = added;
+                peakAddedMove = board.fen() + " " + moveToken;
+            }
+            if (removed > peakRemoved) {
+                peakRemoved = removed;
+                peakRemovedMove = board.fen() + " " + moveToken;
+            }
+            moveCount++;
+
+            for (Color side = Color::WHITE; side <= Color::BLACK; ++side) {
+                KingBucketInfo* kingBucket = &outputAcc->kingBucketInfo[side];
+                // A king crossing the mirror axis refreshes the threat accumulator instead
+                if (inputAcc->kingBucketInfo[side].mirrored != kingBucket->mirrored) {
+                    refreshes++;
+                    continue;
+                }
+
+                ThreatInputs::FeatureList adds, subs;
+                start = readTicks();
+                if (side == Color::WHITE) {
+                    ThreatInputs::addPawnPairDeltas<Color::WHITE>(outputAcc->board, outputAcc->dirtyPiece, kingBucket->mirrored, adds, subs);
+                    nnue->addDirtyThreatDeltas<Color::WHITE>(outputAcc, kingBucket, adds, subs);
+                }
+                else {
+                    ThreatInputs::addPawnPairDeltas<Color::BLACK>(outputAcc->board, outputAcc->dirtyPiece, kingBucket->mirrored, adds, subs);
+                    nnue->addDirtyThreatDeltas<Color::BLACK>(outputAcc, kingBucket, adds, subs);
+                }
+                indexingTicks += readTicks() - start;
+
+                start = readTicks();
+                if (side == Color::WHITE)
+                    nnue->applyRows<FtType::Threat, Color::WHITE>(inputAcc->threatState, outputAcc->threatState, adds, subs);
+                else
+                    nnue->applyRows<FtType::Threat, Color::BLACK>(inputAcc->threatState, outputAcc->threatState, adds, subs);
+                applicationTicks += readTicks() - start;
+                rows += adds.size() + subs.size();
+            }
+
+            board = boardCopy;
+        }
+    }
+
+    if (!moveCount) {
+        std::cout << "info string no moves to replay" << std::endl;
+        return;
+    }
+
+    auto printDistribution = [&](const char* name, const std::array<uint64_t, LIMIT + 1>& histogram, int peak, const std::string& peakMove) {
+        uint64_t total = 0, seen = 0;
+        int median = -1, p99 = -1;
+        for (int count = 0; count <= LIMIT; count++)
+            total += histogram[count] * count;
+        for (int count = 0; count <= LIMIT; count++) {
+            seen += histogram[count];
+            if (median < 0 && 2 * seen >= moveCount)
+                median = count;
+            if (p99 < 0 && 100 * seen >= 99 * moveCount)
+                p99 = count;
+        }
+        std::cout << name << " threats per move: mean " << static_cast<double>(total) / moveCount << ", median " << median << ", p99 " << p99
+                  << ", peak " << peak << " of " << LIMIT << " (" << peakMove << ")" << std::endl;
+        for (int low = 0; low <= LIMIT; low += 8) {
+            uint64_t bucket = 0;
+            for (int count = low; count < low + 8 && count <= LIMIT; count++)
+                bucket += histogram[count];
+            if (bucket)
+                std::cout << "  " << low << "-" << low + 7 << ": " << 100.0 * bucket / moveCount << "%" << std::endl;
+        }
+    };
+
+    uint64_t incrementalUpdates = 2 * moveCount - refreshes;
+    std::cout << std::endl << "--- Threatprofile finished ---" << std::endl;
+    std::cout << "Games: " << games.size() << ", moves: " << moveCount << ", mirror refreshes: " << refreshes << std::endl;
+    printDistribution("Added", addedHistogram, peakAdded, peakAddedMove);
+    printDistribution("Removed", removedHistogram, peakRemoved, peakRemovedMove);
+    std::cout << "Detection (doMove): " << detectionTicks / moveCount << " " << TICKS_UNIT << " per move" << std::endl;
+    std::cout << "Feature indexing: " << indexingTicks / std::max<uint64_t>(incrementalUpdates, 1) << " " << TICKS_UNIT << " per perspective" << std::endl;
+    std::cout << "Row application: " << applicationTicks / std::max<uint64_t>(incrementalUpdates, 1) << " " << TICKS_UNIT << " per perspective ("
+              << static_cast<double>(rows) / std::max<uint64_t>(incrementalUpdates, 1) << " rows)" << std::endl;
+}
+
+// Times the initialisation done on every process start, in main() and when uciLoop sets up the thread pool
+void startupbench(std::string params) {
+    std::istringstream iss(params);
+    std::string token;
+    int iterations = 10;
+
+    iss >> token;
+    if (iss >> token)
+        iterations = std::stoi(token);
+
+    uint64_t totalMicroseconds = 0;
+    auto measure = [&](const char* name, auto&& step) {
+        auto begin = std::chrono::steady_clock::now();
+        for (int iteration = 0; iteration < iterations; iteration++)
+            step();
+        uint64_t microseconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count() / iterations;
+        totalMicroseconds += microseconds;
+        std::cout << name << ": " << microseconds << "us" << std::endl;
+    };
+
+    int numThreads = static_cast<int>(threads.workers.size());
+    std::cout << std::endl << "--- Startupbench finished ---" << std::endl;
+    measure("Magics", generateMagics);
+    measure("Reductions", initReductions);
+    measure("Network data", initNetworkData);
+    measure("Transposition table", [] { TT.clear(); });
+    measure("Thread pool", [] {
+        threads.resize(0);
+        threads.resize(1);
+    });
+    std::cout << "Total: " << totalMicroseconds << "us" << std::endl;
+    threads.resize(numThreads);
+}
+
+// Reads one FEN per line from the book, or takes the bench positions if no book is given
+bool loadFens(const std::string& bookPath, std::vector<std::pair<std::string, bool>>& fens) {
+    if (bookPath.empty()) {
+        int i = 0;
+        for (const std::string& fen : Bench::BENCH_POSITIONS)
+            fens.emplace_back(fen, i++ >= 44);
+        return true;
+    }
+
+    std::ifstream book(bookPath);
+    if (!book) {
+        std::cout << "Could not open " << bookPath << std::endl;
+        return false;
+    }
+    for (std::string fen; std::getline(book, fen);) {
+        if (!fen.empty())
+            fens.emplace_back(fen, UCI::Options.chess960.value);
+    }
+    return true;
+}
+
+void quantbench(std::string params) {
+    std::istringstream iss(params);
+    std::string token;
+    int iterations = 100;
+    std::string bookPath;
+
+    iss >> token;
+    while (iss >> token) {
+        if (token == "book")
+            std::getline(iss >> std::ws, bookPath);
+        else
+            iterations = std::stoi(token);
+    }
+
+    std::vector<std::pair<std::string, bool>> fens;
+    if (!loadFens(bookPath, fens))
+        return;
+
+    std::unique_ptr<NNUE> nnue = std::make_unique<NNUE>(globalNetworkData);
+    Board board;
+
+    // Output differences of the integer L2 / L3 against the float ones, and forward pass timings of both
+    uint64_t differing = 0, totalDifference = 0, floatTicks = 0, integerTicks = 0;
+    int maxDifference = 0, mismatches = 0;
+    for (auto& [fen, chess960] : fens) {
+        board.parseFen(fen, chess960);
+        nnue->reset(&board);
+
+        Eval floatEval = nnue->evaluate<false>(&board);
+        Eval integerEval = nnue->evaluate<true>(&board);
+        int difference = std::abs(floatEval - integerEval);
+        differing += difference != 0;
+        totalDifference += difference;
+        maxDifference = std::max(maxDifference, difference);
+
+        uint64_t start = readTicks();
+        for (int iteration = 0; iteration < iterations; iteration++)
+            mismatches += nnue->evaluate<false>(&board) != floatEval;
+        floatTicks += readTicks() - start;
+
+        start = readTicks();
+        for (int iteration = 0; iteration < iterations; iteration++)
+            mismatches += nnue->evaluate<true>(&board) != integerEval;
+        integerTicks += readTicks() - start;
+    }
+
+    uint64_t evaluations = static_cast<uint64_t>(iterations) * fens.size();
+    std::cout << std::endl << "--- Quantbench finished ---" << std::endl;
+    std::cout << "Positions: " << fens.size() << std::endl;
+    std::cout << "Mismatches: " << mismatches << std::endl;
+    std::cout << "Default layers: " << (USE_INTEGER_LAYERS ? "integer" : "float") << std::endl;
+    std::cout << "Differing evaluations: " << differing << " (" << 100.0 * differing / fens.size() << "%)" << std::endl;
+    std::cout << "Mean absolute difference: " << static_cast<double>(totalDifference) / fens.size() << std::endl;
+    std::cout << "Max absolute difference: " << maxDifference << std::endl;
+    std::cout << "Float forward pass: " << floatTicks / evaluations << " " << TICKS_UNIT << " per evaluate" << std::endl;
+    std::cout << "Integer forward pass: " << integerTicks / evaluations << " " << TICKS_UNIT << " per evaluate" << std::endl;
+}
+
+// Searches all positions, with every worker recording NNZ statistics on the given network
+void profileNNZ(NetworkData* networkData, std::vector<std::pair<std::string, bool>>& fens, int depth, NNZProfile* profile, Board& board, std::vector<Hash>& boardHistory) {
+    threads.waitForSearchFinished();
+    threads.ucinewgame();
+
+    std::vector<NetworkData*> workerNetworks;
+    std::vector<std::unique_ptr<NNZProfile>> workerProfiles;
+    for (auto& worker : threads.workers) {
+        workerNetworks.push_back(worker->nnue.networkData);
+        workerProfiles.push_back(std::make_unique<NNZProfile>());
+        workerProfiles.back()->clear();
+        worker->nnue.networkData = networkData;
+        worker->nnue.nnzProfile = workerProfiles.back().get();
+    }
+
+    boardHistory.clear();
+    boardHistory.push_back(0);
+    for (auto& [fen, chess960] : fens) {
+        board.parseFen(fen, chess960);
+        boardHistory[0] = board.hashes.hash;
+        SearchParameters parameters;
+        parameters.depth = depth;
+
+        threads.startSearching(board, boardHistory, parameters);
+        threads.waitForSearchFinished();
+    }
+
+    profile->clear();
+    for (size_t i = 0; i < threads.workers.size(); i++) {
+        threads.workers[i]->nnue.networkData = workerNetworks[i];
+        threads.workers[i]->nnue.nnzProfile = nullptr;
+        profile->merge(*workerProfiles[i]);
+    }
+}
+
+void nnzprofile(std::string params, Board& board, std::vector<Hash>& boardHistory) {
+    std::istringstream iss(params);
     std::string token;
+    int depth = 13;
+    std::string bookPath;
+
+    iss >> token;
+    while (iss >> token) {
+        if (token == "depth")
+            iss >> depth;
+        else if (token == "book")
+            std::getline(iss >> std::ws, bookPath);
+    }
+
+    std::vector<std::pair<std::string, bool>> fens;
+    if (!loadFens(bookPath, fens))
+        return;
+
+    bool minimal = UCI::Options.minimal.value;
+    UCI::Options.minimal.value = true;
+
+    std::unique_ptr<NNZProfile> profile = std::make_unique<NNZProfile>();
+    profileNNZ(globalNetworkData, fens, depth, profile.get(), board, boardHistory);
+
+    int order[L1_SIZE / 2];
+    profile->computeOrder(order);
+    std::unique_ptr<NetworkData> permuted = std::make_unique<NetworkData>();
+    permuteNetworkNeurons(permuted.get(), globalNetworkData, order);
+
+    // The permutation must not change any evaluation
+    int mismatches = 0;
+    std::unique_ptr<NNUE> reference = std::make_unique<NNUE>(globalNetworkData);
+    std::unique_ptr<NNUE> candidate = std::make_unique<NNUE>(permuted.get());
+    for (auto& [fen, chess960] : fens) {
+        board.parseFen(fen, chess960);
+        reference->reset(&board);
+        candidate->reset(&board);
+        mismatches += reference->evaluate(&board) != candidate->evaluate(&board);
+    }
+
+    std::unique_ptr<NNZProfile> permutedProfile = std::make_unique<NNZProfile>();
+    profileNNZ(permuted.get(), fens, depth, permutedProfile.get(), board, boardHistory);
+
+    UCI::Options.minimal.value = minimal;
+    board.startpos();
+    boardHistory.clear();
+    boardHistory.push_back(board.hashes.hash);
+
+    std::ofstream outfile("./permuted.bin", std::ios::binary);
+    if (!outfile) {
+        std::cout << "Error opening ./permuted.bin for writing" << std::endl;
+        return;
+    }
+    outfile.write(reinterpret_cast<char*>(permuted.get()), sizeof(NetworkData));
+    outfile.close();
+
+    constexpr double chunks = L1_SIZE / INT8_PER_INT32;
+    std::cout << std::endl << "--- NNZ profile finished ---" << std::endl;
+    std::cout << "Positions: " << fens.size() << " (depth " << depth << ")" << std::endl;
+    std::cout << "Mismatches: " << mismatches << std::endl;
+    std::cout << "Non-zero L1 input chunks per bucket (measured / expected after permutation / measured after permutation):" << std::endl;
+    uint64_t evaluations = 0, nonZeroBefore = 0, nonZeroAfter = 0;
+    for (int b = 0; b < OUTPUT_BUCKETS; b++) {
+        evaluations += profile->evaluations[b];
+        nonZeroBefore += profile->nonZeroChunks[b];
+        nonZeroAfter += permutedProfile->nonZeroChunks[b];
+        if (!profile->evaluations[b])
+            continue;
+        std::cout << "  bucket " << b << " (" << profile->evaluations[b] << " evaluations): "
+            << 100.0 * profile->nonZeroChunks[b] / profile->evaluations[b] / chunks << "% / "
+            << 100.0 * profile->expectedNonZeroChunks(b, order) / chunks << "% / "
+            << 100.0 * permutedProfile->nonZeroChunks[b] / std::max<uint64_t>(1, permutedProfile->evaluations[b]) / chunks << "%" << std::endl;
+    }
+    std::cout << "Total: " << 100.0 * nonZeroBefore / std::max<uint64_t>(1, evaluations) / chunks << "% -> " << 100.0 * nonZeroAfter / std::max<uint64_t>(1, evaluations) / chunks << "%" << std::endl;
+    std::cout << "Permuted net written to ./permuted.bin" << std::endl;
+}
+
+// Applies pending option changes, then sizes the pool for a batch command without changing the Threads option
+void resizeForBatch(int numThreads) {
+    threads.waitForSearchFinished();
+    if (UCI::optionsDirty) {
+        threads.resize(UCI::Options.threads.value);
+        TT.resize(UCI::Options.hash.value);
+        UCI::optionsDirty = false;
+    }
+    threads.resize(numThreads);
+}
+
+// Generates FENs on all workers, the output only depends on the seed and not on the number of threads
+// Usage: genfens <n> [seed <n>] [threads <n>] [book <path>]
+void genfens(std::string params, Board& board, std::vector<Hash>& boardHistory) {
+    std::string token, bookName;
     SearchParameters parameters;
     parameters.genfens = true;
+    int numThreads = UCI::Options.threads.value;
 
     while (nextToken(&params, &token)) {
         if (matchesToken(token, "genfens")) {
@@ -424,15 +1246,158 @@ void genfens(std::string params, Board& board, std::vector<Hash>& boardHistory)
             nextToken(&params, &token);
             parameters.genfensSeed = std::stoi(token);
         }
+        if (matchesToken(token, "threads")) {
+            nextToken(&params, &token);
+            numThreads = std::stoi(token);
+        }
         if (matchesToken(token, "book")) {
-            parameters.genfensBook = params;
+            bookName = params;
             params = "";
         }
     }
 
+    // The book is opened once and shared by all workers
+    OpeningBook book;
+    bookName.erase(std::find_if(bookName.rbegin(), bookName.rend(), [](unsigned char ch) {
+        return !std::isspace(ch);
+    }).base(), bookName.end());
+    if (bookName.length() > 0 && bookName != "None") {
+        if (!book.open((std::filesystem::current_path() / bookName).string())) {
+            std::cout << "info string unable to find genfens file" << std::endl;
+            return;
+        }
+    }
+
+    resizeForBatch(numThreads);
+    threads.genfensBook = &book;
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
     TT.newSearch();
     threads.startSearching(board, boardHistory, parameters);
     threads.waitForSearchFinished();
+    threads.genfensBook = nullptr;
+    threads.resize(UCI::Options.threads.value);
+
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    double seconds = std::max<double>(1, std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count()) / 1000;
+    std::cout << "info string generated " << threads.genfensPrinted << " fens with " << numThreads << " threads in " << seconds << "s => "
+        << threads.genfensPrinted / seconds << " fens/s" << std::endl;
+}
+
+// Searches every position of an EPD/FEN file on a single worker, all workers pulling positions in parallel
+// Usage: analyse <file> [depth <n>] [nodes <n>] [threads <n>] [output <file>]
+void analyse(std::string params, Board& board, std::vector<Hash>& boardHistory) {
+    std::istringstream iss(params);
+    std::string token, inputPath, outputPath;
+    SearchParameters parameters;
+    parameters.analyse = true;
+    int numThreads = UCI::Options.threads.value;
+
+    iss >> token >> inputPath;
+    while (iss >> token) {
+        if (token == "depth" && iss >> token)
+            parameters.depth = std::stoi(token);
+        else if (token == "nodes" && iss >> token)
+            parameters.nodes = std::stoull(token);
+        else if (token == "threads" && iss >> token)
+            numThreads = std::stoi(token);
+        else if (token == "output" && iss >> token)
+            outputPath = token;
+    }
+    if (parameters.depth == 0 && parameters.nodes == 0)
+        parameters.depth = 10;
+
+    std::ifstream input(inputPath);
+    if (!input.good()) {
+        std::cout << "info string unable to open " << inputPath << std::endl;
+        return;
+    }
+    std::vector<std::string> positions;
+    for (std::string line; std::getline(input, line);) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (!line.empty() && line[0] != '#')
+            positions.push_back(line);
+    }
+
+    std::ofstream output;
+    if (!outputPath.empty()) {
+        output.open(outputPath);
+        if (!output.good()) {
+            std::cout << "info string unable to open " << outputPath << std::endl;
+            return;
+        }
+    }
+
+    resizeForBatch(numThreads);
+
+    size_t totalPositions = positions.size();
+    threads.analysePositions = std::move(positions);
+    threads.analyseOutput = outputPath.empty() ? &std::cout : &output;
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+    TT.newSearch();
+    threads.startSearching(board, boardHistory, parameters);
+    threads.waitForSearchFinished();
+
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    int64_t elapsed = std::max<int64_t>(1, std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count());
+    uint64_t nodes = threads.analyseNodes.load(std::memory_order_relaxed);
+
+    threads.analyseOutput->flush();
+    threads.analyseOutput = nullptr;
+    threads.analysePositions.clear();
+    threads.resize(UCI::Options.threads.value);
+
+    std::cout << "info string analysed " << totalPositions << " positions with " << numThreads << " threads in " << elapsed << "ms => "
+        << 1000 * totalPositions / elapsed << " positions/s, " << 1000 * nodes / elapsed << " nps" << std::endl;
+}
+
+// Plays self-play games on all workers and writes their quiet positions as binary training data
+// Usage: selfplay <games> [nodes <n>] [threads <n>] [seed <n>] [output <prefix>]
+void selfplay(std::string params, Board& board, std::vector<Hash>& boardHistory) {
+    std::istringstream iss(params);
+    std::string token;
+    SearchParameters parameters;
+    parameters.selfplay = true;
+    parameters.nodes = 5000;
+    std::string outputPrefix = "selfplay";
+    int numThreads = UCI::Options.threads.value;
+
+    iss >> token;
+    if (iss >> token)
+        parameters.selfplayGames = std::stoi(token);
+    while (iss >> token) {
+        if (token == "nodes" && iss >> token)
+            parameters.nodes = std::stoull(token);
+        else if (token == "threads" && iss >> token)
+            numThreads = std::stoi(token);
+        else if (token == "seed" && iss >> token)
+            parameters.selfplaySeed = std::stoi(token);
+        else if (token == "output" && iss >> token)
+            outputPrefix = token;
+    }
+
+    resizeForBatch(numThreads);
+    threads.ucinewgame();
+    threads.selfplayOutput = outputPrefix;
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+    TT.newSearch();
+    threads.startSearching(board, boardHistory, parameters);
+    threads.waitForSearchFinished();
+
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    double seconds = std::max<double>(1, std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count()) / 1000;
+    int games = threads.selfplayGamesPlayed.load(std::memory_order_relaxed);
+    uint64_t positions = threads.selfplayPositions.load(std::memory_order_relaxed);
+    threads.resize(UCI::Options.threads.value);
+
+    std::cout << "info string played " << games << " games (" << positions << " positions) with " << numThreads << " threads in " << seconds << "s => "
+        << static_cast<uint64_t>(3600 * games / seconds) << " games/h, " << static_cast<uint64_t>(positions / seconds) << " positions/s" << std::endl;
 }
 
 struct printOptions
@@ -483,6 +1448,57 @@ void uciLoop(int argc, char* argv[]) {
         speedtest(board, boardHistory);
         return;
     }
+    if (argc > 1 && matchesToken(argv[1], "evalbench")) {
+        evalbench(argc > 2 ? "evalbench " + std::string(argv[2]) : "evalbench");
+        return;
+    }
+    if (argc > 1 && matchesToken(argv[1], "threatbench")) {
+        threatbench(argc > 2 ? "threatbench " + std::string(argv[2]) : "threatbench");
+        return;
+    }
+    if (argc > 1 && matchesToken(argv[1], "analyse")) {
+        std::string params(argv[1]);
+        for (int i = 2; i < argc; i++)
+            params += " " + std::string(argv[i]);
+        analyse(params, board, boardHistory);
+        return;
+    }
+    if (argc > 1 && matchesToken(argv[1], "selfplay")) {
+        std::string params(argv[1]);
+        for (int i = 2; i < argc; i++)
+            params += " " + std::string(argv[i]);
+        selfplay(params, board, boardHistory);
+        return;
+    }
+    if (argc > 1 && matchesToken(argv[1], "matebench")) {
+        matebench(argc > 2 ? "matebench " + std::string(argv[2]) : "matebench", board, boardHistory);
+        return;
+    }
+    if (argc > 1 && matchesToken(argv[1], "startupbench")) {
+        startupbench(argc > 2 ? "startupbench " + std::string(argv[2]) : "startupbench");
+        return;
+    }
+    if (argc > 1 && matchesToken(argv[1], "threatprofile")) {
+        std::string params = "threatprofile";
+        for (int i = 2; i < argc; i++)
+            params += " " + std::string(argv[i]);
+        threatprofile(params);
+        return;
+    }
+    if (argc > 1 && matchesToken(argv[1], "quantbench")) {
+        std::string params = "quantbench";
+        for (int i = 2; i < argc; i++)
+            params += " " + std::string(argv[i]);
+        quantbench(params);
+        return;
+    }
+    if (argc > 1 && matchesToken(argv[1], "nnzprofile")) {
+        std::string params = "nnzprofile";
+        for (int i = 2; i < argc; i++)
+            params += " " + std::string(argv[i]);
+        nnzprofile(params, board, boardHistory);
+        return;
+    }
     for (std::string line = {};std::getline(std::cin, line);) {
 
         if (matchesToken(line, "quit")) {
@@ -531,6 +1547,15 @@ void uciLoop(int argc, char* argv[]) {
 
         /* NON UCI COMMANDS */
         else if (matchesToken(line, "bench")) bench(board, boardHistory);
+        else if (matchesToken(line, "evalbench")) evalbench(line);
+        else if (matchesToken(line, "nnzprofile")) nnzprofile(line, board, boardHistory);
+        else if (matchesToken(line, "quantbench")) quantbench(line);
+        else if (matchesToken(line, "threatbench")) threatbench(line);
+        else if (matchesToken(line, "matebench")) matebench(line, board, boardHistory);
+        else if (matchesToken(line, "analyse")) analyse(line, board, boardHistory);
+        else if (matchesToken(line, "selfplay")) selfplay(line, board, boardHistory);
+        else if (matchesToken(line, "threatprofile")) threatprofile(line);
+        else if (matchesToken(line, "startupbench")) startupbench(line);
         else if (matchesToken(line, "perfttest")) perfttest(board, boardHistory);
         else if (matchesToken(line, "debug")) board.debugBoard();
         else if (matchesToken(line, "eval")) {
@@ -3,24 +3,152 @@
 #include <cstdint>
 
 #include "types.h"
+#include "bitboard.h"
+#include "board.h"
 
 namespace Zobrist {
 
     constexpr int FMR_GRANULARITY = 10;
 
-    extern Hash PIECE_SQUARES[2][Piece::TOTAL][64];
-    extern Hash STM_BLACK;
-    extern Hash NO_PAWNS;
-    extern Hash CASTLING[16]; // 2^4
-    extern Hash ENPASSENT[8]; // 8 files
-    extern Hash FMR[110 / FMR_GRANULARITY];
-
-    extern Hash CUCKOO_HASHES[8192];
-    extern Move CUCKOO_MOVES[8192];
-
     constexpr int H1(Hash h) { return h & 0x1fff; }
     constexpr int H2(Hash h) { return (h >> 16) & 0x1fff; }
 
-    void init();
+    // std::mt19937, with two outputs per key combined like libstdc++'s std::uniform_int_distribution<uint64_t> does
+    class KeyGenerator {
+        static constexpr int STATE_SIZE = 624;
+
+        uint32_t state[STATE_SIZE] = {};
+        int index = STATE_SIZE;
+
+        constexpr void twist() {
+            for (int i = 0; i < STATE_SIZE; i++) {
+                uint32_t y = (state[i] & 0x80000000U) | (state[(i + 1) % STATE_SIZE] & 0x7FFFFFFFU);
+                state[i] = state[(i + 397) % STATE_SIZE] ^ (y >> 1) ^ ((y & 1) ? 0x9908B0DFU : 0);
+            }
+            index = 0;
+        }
+
+        constexpr uint32_t next32() {
+            if (index == STATE_SIZE)
+                twist();
+            uint32_t y = state[index++];
+            y ^= y >> 11;
+            y ^= (y << 7) & 0x9D2C5680U;
+            y ^= (y << 15) & 0xEFC60000U;
+            return y ^ (y >> 18);
+        }
+
+    public:
+
+        constexpr KeyGenerator(uint32_t seed) {
+            state[0] = seed;
+            for (int i = 1; i < STATE_SIZE; i++)
+                state[i] = 1812433253U * (state[i - 1] ^ (state[i - 1] >> 30)) + i;
+        }
+
+        constexpr Hash next() {
+            Hash high = next32();
+            return (high << 32) | next32();
+        }
+    };
+
+    struct Keys {
+        Hash pieceSquares[2][Piece::TOTAL][64];
+        Hash stmBlack;
+        Hash noPawns;
+        Hash castling[16]; // 2^4
+        Hash enpassent[8]; // 8 files
+        Hash fmr[110 / FMR_GRANULARITY];
+
+        Hash cuckooHashes[8192];
+        Move cuckooMoves[8192];
+    };
+
+    inline constexpr Keys KEYS = [] {
+        Keys keys{};
+        KeyGenerator rng(934572);
+
+        for (Color side = Color::WHITE; side <= Color::BLACK; ++side) {
+            for (Piece i = Piece::PAWN; i < Piece::TOTAL; ++i) {
+                for (Square j = 0; j < 64; j++) {
+                    keys.pieceSquares[side][i][j] = rng.next();
+                }
+            }
+        }
+        keys.stmBlack = rng.next();
+        keys.noPawns = rng.next();
+
+        keys.castling[0] = 0;
+        keys.castling[Castling::getMask(Color::WHITE, Castling::KINGSIDE)] = rng.next();
+        keys.castling[Castling::getMask(Color::WHITE, Castling::QUEENSIDE)] = rng.next();
+        keys.castling[Castling::getMask(Color::BLACK, Castling::KINGSIDE)] = rng.next();
+        keys.castling[Castling::getMask(Color::BLACK, Castling::QUEENSIDE)] = rng.next();
+        for (uint8_t i = 0; i < 16; i++) {
+            if (BB::popcount(i) < 2)
+                continue;
+
+            Hash hash = 0;
+            if (i & Castling::getMask(Color::WHITE, Castling::KINGSIDE))
+                hash ^= keys.castling[Castling::getMask(Color::WHITE, Castling::KINGSIDE)];
+            if (i & Castling::getMask(Color::WHITE, Castling::QUEENSIDE))
+                hash ^= keys.castling[Castling::getMask(Color::WHITE, Castling::QUEENSIDE)];
+            if (i & Castling::getMask(Color::BLACK, Castling::KINGSIDE))
+                hash ^= keys.castling[Castling::getMask(Color::BLACK, Castling::KINGSIDE)];
+            if (i & Castling::getMask(Color::BLACK, Castling::QUEENSIDE))
+                hash ^= keys.castling[Castling::getMask(Color::BLACK, Castling::QUEENSIDE)];
+            keys.castling[i] = hash;
+        }
+
+        for (int i = 0; i < 8; i++) {
+            keys.enpassent[i] = rng.next();
+        }
+
+        Hash zobristLowLmr = rng.next();
+        for (int i = 0; i < 100 / FMR_GRANULARITY; i++) {
+            if (i * FMR_GRANULARITY <= 50)
+                keys.fmr[i] = zobristLowLmr;
+            else
+                keys.fmr[i] = rng.next();
+        }
+
+        for (Color side = Color::WHITE; side <= Color::BLACK; ++side) {
+            for (Piece piece = Piece::KNIGHT; piece < Piece::TOTAL; ++piece) {
+                for (Square squareA = 0; squareA < 64; squareA++) {
+                    for (Square squareB = squareA + 1; squareB < 64; squareB++) {
+                        // Check if there is a reversible move between squareA and squareB
+                        if (BB::pseudoAttacks(piece, squareA, side) & bitboard(squareB)) {
+                            Move move = Move::makeNormal(squareA, squareB);
+                            Hash hash = keys.pieceSquares[side][piece][squareA] ^ keys.pieceSquares[side][piece][squareB] ^ keys.stmBlack;
+                            int i = H1(hash);
+                            // Find an empty slot in the cuckoo table for this move/hash combination
+                            while (true) {
+                                Hash slotHash = keys.cuckooHashes[i];
+                                Move slotMove = keys.cuckooMoves[i];
+                                keys.cuckooHashes[i] = hash;
+                                keys.cuckooMoves[i] = move;
+                                hash = slotHash;
+                                move = slotMove;
+                                if (!move)
+                                    break;
+                                i = (i == H1(hash)) ? H2(hash) : H1(hash);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        return keys;
+    }();
+
+    inline constexpr auto& PIECE_SQUARES = KEYS.pieceSquares;
+    inline constexpr const Hash& STM_BLACK = KEYS.stmBlack;
+    inline constexpr const Hash& NO_PAWNS = KEYS.noPawns;
+    inline constexpr auto& CASTLING = KEYS.castling;
+    inline constexpr auto& ENPASSENT = KEYS.enpassent;
+    inline constexpr auto& FMR = KEYS.fmr;
+
+    inline constexpr auto& CUCKOO_HASHES = KEYS.cuckooHashes;
+    inline constexpr auto& CUCKOO_MOVES = KEYS.cuckooMoves;
 
 }
@@ -23,6 +23,11 @@ constexpr int L3_SIZE = 32;
 
 constexpr int INPUT_QUANT = 255;
 constexpr int L1_QUANT = 64;
+constexpr int INPUT_SHIFT = 9;
+
+constexpr float L1_NORMALISATION = static_cast<float>(1 << INPUT_SHIFT) / static_cast<float>(INPUT_QUANT * INPUT_QUANT * L1_QUANT);
+constexpr int HIDDEN_ACTIVATION_SHIFT = 9;
+constexpr int HIDDEN_WEIGHT_SHIFT = 10;
 
 constexpr int ALIGNMENT = 64;
 constexpr int INT8_PER_INT32 = sizeof(int32_t) / sizeof(int8_t);
@@ -49,6 +54,11 @@ struct NetworkData {
     alignas(ALIGNMENT) float l2Biases[OUTPUT_BUCKETS][L3_SIZE];
     alignas(ALIGNMENT) float l3Weights[OUTPUT_BUCKETS][L3_SIZE + 2 * L2_SIZE];
     alignas(ALIGNMENT) float l3Biases[OUTPUT_BUCKETS];
+    alignas(ALIGNMENT) int32_t l1BiasesQuantised[OUTPUT_BUCKETS][L2_SIZE];
+    alignas(ALIGNMENT) int16_t l2WeightsQuantised[OUTPUT_BUCKETS][2 * L2_SIZE * L3_SIZE];
+    alignas(ALIGNMENT) int32_t l2BiasesQuantised[OUTPUT_BUCKETS][L3_SIZE];
+    alignas(ALIGNMENT) int16_t l3WeightsQuantised[OUTPUT_BUCKETS][L3_SIZE + 2 * L2_SIZE];
+    alignas(ALIGNMENT) int32_t l3BiasesQuantised[OUTPUT_BUCKETS];
 };
 
 RawNetworkData raw;
@@ -60,6 +70,14 @@ int16_t quantize(float number) {
     return static_cast<int16_t>(std::round(number * static_cast<float>(Q)));
 }
 
+int16_t quantizeHiddenWeight(float number) {
+    return static_cast<int16_t>(std::clamp<float>(std::round(number * (1 << HIDDEN_WEIGHT_SHIFT)), INT16_MIN, INT16_MAX));
+}
+
+int32_t quantizeHiddenBias(float number) {
+    return static_cast<int32_t>(std::round(number * (1 << (HIDDEN_ACTIVATION_SHIFT + HIDDEN_WEIGHT_SHIFT))));
+}
+
 uint64_t readULEB128(std::istream& is) {
     constexpr int MAX_ITER = 1000000;
     int iter = 0;
@@ -219,6 +237,29 @@ void transposePermuteNetwork() {
     std::memcpy(out.l3Biases, tmp.l3Biases, sizeof(tmp.l3Biases));
 }
 
+void quantizeHiddenLayers() {
+    // Integer L2 / L3 for the INTEGER_LAYERS inference path, computed from the transposed float layers
+    for (int b = 0; b < OUTPUT_BUCKETS; b++) {
+        for (int l2 = 0; l2 < L2_SIZE; l2++) {
+            out.l1BiasesQuantised[b][l2] = static_cast<int32_t>(std::round(out.l1Biases[b][l2] / L1_NORMALISATION));
+        }
+
+        for (int l2 = 0; l2 < 2 * L2_SIZE; l2++) {
+            for (int l3 = 0; l3 < L3_SIZE; l3++) {
+                out.l2WeightsQuantised[b][(l2 / 2) * 2 * L3_SIZE + l3 * 2 + l2 % 2] = quantizeHiddenWeight(out.l2Weights[b][l2 * L3_SIZE + l3]);
+            }
+        }
+        for (int l3 = 0; l3 < L3_SIZE; l3++) {
+            out.l2BiasesQuantised[b][l3] = quantizeHiddenBias(out.l2Biases[b][l3]);
+        }
+
+        for (int l3 = 0; l3 < L3_SIZE + 2 * L2_SIZE; l3++) {
+            out.l3WeightsQuantised[b][l3] = quantizeHiddenWeight(out.l3Weights[b][l3]);
+        }
+        out.l3BiasesQuantised[b] = quantizeHiddenBias(out.l3Biases[b]);
+    }
+}
+
 int main(int argc, char* argv[]) {
     if (argc < 4) {
         std::cerr << "Usage: " << argv[0] << " <infile_is_floats> <infile> <outfile>\n";
@@ -271,6 +312,7 @@ int main(int argc, char* argv[]) {
     }
 
     transposePermuteNetwork();
+    quantizeHiddenLayers();
 
     // Write the network
     std::ofstream outfile(outfilefile_name, std::ios::binary);